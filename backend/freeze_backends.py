@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+
+# Compile all backend modules below some directory (usually 'backend/impl') to
+# bytecode and write a C++ source file containing them. CPPBind imports
+# backend modules from this source file instead of from the source tree (see
+# 'backend::run') unless '--backend-from-source' is given. This must be run by
+# the same Python version that CPPBind embeds, since bytecode is not portable
+# between Python versions.
+
+import argparse
+import importlib.util
+import marshal
+import os
+
+
+def frozen_modules(impl_dir):
+    root_dir = os.path.dirname(os.path.dirname(os.path.abspath(impl_dir)))
+
+    modules = []
+
+    for dirpath, dirnames, filenames in os.walk(impl_dir):
+        dirnames[:] = sorted(d for d in dirnames if d != '__pycache__')
+
+        for filename in sorted(filenames):
+            name, ext = os.path.splitext(filename)
+            if ext != '.py':
+                continue
+
+            path = os.path.join(dirpath, filename)
+
+            with open(path, 'r') as f:
+                source = f.read()
+
+            # Tracebacks refer to paths relative to the repository root so
+            # that the output does not depend on the location of the build.
+            code = compile(source, os.path.relpath(path, root_dir), 'exec')
+
+            modules.append((name, marshal.dumps(code)))
+
+    names = [name for name, _ in modules]
+    duplicates = sorted({name for name in names if names.count(name) > 1})
+
+    if duplicates:
+        raise ValueError(f"duplicate backend modules: {', '.join(duplicates)}")
+
+    return modules
+
+
+def byte_array(data):
+    lines = []
+
+    for i in range(0, len(data), 16):
+        lines.append('  ' + ', '.join(f'0x{b:02x}' for b in data[i:i + 16]) + ',')
+
+    return '\n'.join(lines)
+
+
+def frozen_modules_source(modules):
+    arrays = []
+    entries = []
+
+    for i, (name, code) in enumerate(modules):
+        arrays.append(f"unsigned char const Module{i}[] = {{\n{byte_array(code)}\n}};")
+        entries.append(f'  {{"{name}", Module{i}, sizeof(Module{i})}},')
+
+    arrays = '\n\n'.join(arrays)
+    entries = '\n'.join(entries)
+
+    magic = byte_array(importlib.util.MAGIC_NUMBER)
+
+    return f"""\
+// Generated by backend/freeze_backends.py, do not edit.
+
+#include "FrozenBackends.hpp"
+
+namespace
+{{
+
+unsigned char const Magic[] = {{
+{magic}
+}};
+
+{arrays}
+
+cppbind::backend::FrozenModule const Modules[] = {{
+{entries}
+}};
+
+}} // namespace
+
+namespace cppbind
+{{
+
+namespace backend
+{{
+
+llvm::ArrayRef<unsigned char> frozenModulesMagic()
+{{ return Magic; }}
+
+llvm::ArrayRef<FrozenModule> frozenModules()
+{{ return Modules; }}
+
+}} // namespace backend
+
+}} // namespace cppbind
+"""
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('impl_dir')
+    parser.add_argument('output')
+
+    args = parser.parse_args()
+
+    source = frozen_modules_source(frozen_modules(args.impl_dir))
+
+    with open(args.output, 'w') as f:
+        f.write(source)
+
+
+if __name__ == '__main__':
+    main()
@@ -2,17 +2,25 @@
 # from 'Backend(...)' which implements a set of 'wrap_*' functions that control
 # code generation.
 
+import common_module
 from abc import ABCMeta, abstractmethod
-from file import File, Path
+from common_module import CommonModule
+from file import File, FileShards, Path
 from itertools import chain
 from pycppbind import Enum, Function, Options, Record, Type, Variable
+from text import code
 import os
+import pickle
+import sys
+import traceback
 
 
 class BackendState:
     def __init__(self):
         self.impls = {} # Backend implementations
         self.insts = {} # Backend instantiations
+        self.pending = {} # Backends initialized but not yet instantiated
+        self.analyses = {} # Wrapper analyses shared between backends
 
         self.current_name = None # Current backend instance name
         self.current_inst = None # Current backend instance
@@ -27,21 +35,47 @@ def register_backend(be, impl):
     _state.impls[be] = impl
 
 
-# Initialize a new backend.
+# Initialize a new backend. The backend is only instantiated once it is first
+# used, i.e. a backend that is never switched to (like the C backend during a
+# pure Lua run) costs nothing.
 def initialize_backend(be, input_file, wrapper):
     global _state
 
     if be not in _state.impls:
         raise ValueError(f"backend '{be}' does not exist")
 
-    _state.insts[be] = _state.impls[be](input_file, wrapper)
+    _state.insts.pop(be, None)
+    _state.pending[be] = (input_file, wrapper)
+
+
+def _instantiate_backend(be):
+    global _state
+
+    if be in _state.pending:
+        input_file, wrapper = _state.pending.pop(be)
+        _state.insts[be] = _state.impls[be](input_file, wrapper)
+
+    return _state.insts.get(be)
+
+
+# Obtain the analysis of a wrapper's entities, this is computed once per
+# wrapper and shared read-only between all backend instances.
+def wrapper_analysis(wrapper):
+    global _state
+
+    key = id(wrapper)
+
+    if key not in _state.analyses:
+        _state.analyses[key] = (wrapper, WrapperAnalysis(wrapper))
+
+    return _state.analyses[key][1]
 
 
 # Set current backend instance.
 def set_backend_instance(be):
     global _state
 
-    if be not in _state.insts:
+    if _instantiate_backend(be) is None:
         raise ValueError(f"backend '{be}' is not initialized")
 
     if _state.current_inst is not None:
@@ -61,7 +95,7 @@ def get_backend_instance(be='current'):
         be = _state.current_name
         inst = _state.current_inst
     else:
-        inst = _state.insts.get(be)
+        inst = _instantiate_backend(be)
 
     if inst is None:
         raise ValueError("no backend instance found")
@@ -69,6 +103,173 @@ def get_backend_instance(be='current'):
     return be, inst
 
 
+# Analysis of the entities contained in a wrapper which does not depend on any
+# particular backend: the namespace hierarchy, the sets of types and type
+# aliases used and the classification of record types. This used to be
+# recomputed by every backend instance, it is now computed once per wrapper and
+# must be treated as read-only by backends.
+class WrapperAnalysis:
+    def __init__(self, wrapper):
+        self._includes = wrapper.includes()
+        self._macros = wrapper.macros()
+
+        self._enums = wrapper.enums()
+        self._variables = wrapper.variables()
+        self._functions = wrapper.functions()
+        self._records = wrapper.records()
+
+        self._objects = self._enums + \
+                        self._variables + \
+                        self._records + \
+                        self._functions
+
+        self._add_types()
+
+        self._add_namespaces()
+
+        self._add_record_types()
+
+    # Construct a "namespace hierarchy" of all entities of interest in the
+    # input translation unit with namespaces being modelled as nested Python
+    # dictionaries. This is useful because it lets backends implement their
+    # own scoping mechanisms in order to imitate namespaces etc. An example is
+    # Lua where namespaces etc. are realized as tables.
+    def _add_namespaces(self):
+        self._namespaces = {}
+
+        self._init_namespace(self._namespaces)
+
+        self._namespaces['macros'] = self._macros
+
+        for obj in self._objects:
+            self._insert_into_namespace(self._namespaces, obj)
+
+    def _init_namespace(self, ns):
+        if 'namespaces' not in ns:
+            ns['namespaces'] = {}
+
+        keys = [
+            'macros',
+            'enums',
+            'variables',
+            'records',
+            'functions'
+        ]
+
+        for key in keys:
+            if key not in ns:
+                ns[key] = []
+
+    def _insert_into_namespace(self, ns, obj):
+        namespace = obj.namespace()
+        if namespace is not None:
+            for c in namespace.components():
+                if c not in ns['namespaces']:
+                    ns['namespaces'][c] = {}
+
+                ns = ns['namespaces'][c]
+                self._init_namespace(ns)
+
+        object_keys = [
+            (Enum, 'enums'),
+            (Variable, 'variables'),
+            (Record, 'records'),
+            (Function, 'functions')
+        ]
+
+        for t, key in object_keys:
+            if isinstance(obj, t):
+                ns[key].append(obj)
+                break
+
+    # Determine sets of types used in the input translation unit.
+    def _add_types(self):
+        types = set()
+        type_aliases = set()
+
+        def add_type(t):
+            while t.is_alias():
+                if t.is_basic():
+                    type_aliases.add((t, t.canonical()))
+                    break
+                elif t.is_const():
+                    t = t.without_const()
+                elif t.is_pointer() or t.is_reference():
+                    t = t.pointee()
+
+            if not t.is_void():
+                types.add(t.unqualified())
+
+            if t.is_enum():
+                add_type(t.underlying_integer_type())
+            elif t.is_pointer() or t.is_reference():
+                while t.is_pointer() or t.is_reference():
+                    if t.pointee().is_void():
+                        types.add(t.pointee().unqualified())
+                        break
+                    else:
+                        t = t.pointee()
+                        types.add(t.unqualified())
+
+        variables = self._variables + [m.as_variable() for m in self._macros]
+
+        for e in self._enums:
+            variables += [c.as_variable() for c in e.constants()]
+
+        records = [r for r in self._records if r.is_definition()]
+
+        for v in variables:
+            add_type(v.type())
+
+        for r in records:
+            add_type(r.type())
+
+        for f in chain(self._functions, *(r.functions() for r in records)):
+            for t in [f.return_type()] + [p.type() for p in f.parameters()]:
+                add_type(t)
+
+        self._types = sorted(types)
+
+        # Which of these aliases are relevant depends on the target type names
+        # of the backend using them (see 'BackendGeneric.type_aliases').
+        self._type_aliases = sorted(type_aliases)
+
+    def _add_record_types(self):
+        types_all = set()
+        types_defined = set()
+
+        for t in self._types:
+            if t.is_alias():
+                t = t.canonical()
+
+            if t.is_record():
+                types_all.add(t.without_const())
+            elif t.is_record_indirection():
+                types_all.add(t.pointee().without_const())
+
+        for r in self._records:
+            if r.is_definition():
+                types_defined.add(r.type())
+
+        self._record_types = {
+            'all': sorted(types_all),
+            'defined': sorted(types_defined),
+            'used': sorted(types_all - types_defined)
+        }
+
+    def namespaces(self):
+        return self._namespaces
+
+    def types(self):
+        return self._types[:]
+
+    def type_aliases(self):
+        return self._type_aliases[:]
+
+    def record_types(self, which='all'):
+        return self._record_types[which][:]
+
+
 # Create a backend base class where 'be' is be the name of the backend. For
 # example, the C backend should inherit from 'Backend('c')'.
 def Backend(be):
@@ -89,10 +290,16 @@ def Backend(be):
 
 
     class BackendGeneric(metaclass=BackendMeta):
+        # Other backends this backend runs internally, e.g. ('c',) for
+        # backends that build on top of intermediate C bindings.
+        DEPENDENCIES = ()
+
         def __init__(self, input_file, wrapper):
             self._input_file = Path(input_file)
             self._output_files = []
 
+            self._finished = False
+
             self._includes = wrapper.includes()
             self._macros = wrapper.macros()
 
@@ -101,108 +308,10 @@ def Backend(be):
             self._functions = wrapper.functions()
             self._records = wrapper.records()
 
-            self._objects = self._enums + \
-                            self._variables + \
-                            self._records + \
-                            self._functions
-
-            self._add_types()
-
-            self._add_namespaces()
-
-        # Construct a "namespace hierarchy" of all entities of interest in the
-        # input translation unit with namespaces being modelled as nested
-        # Python dictionaries. This is useful because it lets backends
-        # implement their own scoping mechanisms in order to imitate namespaces
-        # etc. An example is Lua where namespaces etc. are realized as tables.
-        def _add_namespaces(self):
-            self._namespaces = {}
+            self._analysis = wrapper_analysis(wrapper)
 
-            self._init_namespace(self._namespaces)
-
-            self._namespaces['macros'] = self._macros
-
-            for obj in self._objects:
-                self._insert_into_namespace(self._namespaces, obj)
-
-        def _init_namespace(self, ns):
-            if 'namespaces' not in ns:
-                ns['namespaces'] = {}
-
-            keys = [
-                'macros',
-                'enums',
-                'variables',
-                'records',
-                'functions'
-            ]
-
-            for key in keys:
-                if key not in ns:
-                    ns[key] = []
-
-        def _insert_into_namespace(self, ns, obj):
-            namespace = obj.namespace()
-            if namespace is not None:
-                for c in namespace.components():
-                    if c not in ns['namespaces']:
-                        ns['namespaces'][c] = {}
-
-                    ns = ns['namespaces'][c]
-                    self._init_namespace(ns)
-
-            object_keys = [
-                (Enum, 'enums'),
-                (Variable, 'variables'),
-                (Record, 'records'),
-                (Function, 'functions')
-            ]
-
-            for t, key in object_keys:
-                if isinstance(obj, t):
-                    ns[key].append(obj)
-                    break
-
-        # Determine sets of types used in the input translation unit.
-        def _add_types(self):
-            self._types = set()
-            self._type_aliases = set()
             self._type_aliases_target = None
 
-            def add_type(t):
-                while t.is_alias():
-                    if t.is_basic():
-                        self._type_aliases.add((t, t.canonical()))
-                        break
-                    elif t.is_const():
-                        t = t.without_const()
-                    elif t.is_pointer() or t.is_reference():
-                        t = t.pointee()
-
-                if not t.is_void():
-                    self._types.add(t.unqualified())
-
-                if t.is_enum():
-                    add_type(t.underlying_integer_type())
-                elif t.is_pointer() or t.is_reference():
-                    while t.is_pointer() or t.is_reference():
-                        if t.pointee().is_void():
-                            self._types.add(t.pointee().unqualified())
-                            break
-                        else:
-                            t = t.pointee()
-                            self._types.add(t.unqualified())
-
-            for v in self.variables(include_macros=True, include_enums=True):
-                add_type(v.type())
-
-            for r in self.records():
-                add_type(r.type())
-
-            for f in chain(self._functions, *(r.functions() for r in self.records())):
-                for t in [f.return_type()] + [p.type() for p in f.parameters()]:
-                    add_type(t)
-
         @abstractmethod
         def patcher(self):
             pass
@@ -229,22 +338,120 @@ def Backend(be):
 
             return output_file
 
+        # If '--output-common-module' is given, return the common module of
+        # this backend, 'filename' and 'ext' are interpreted as by
+        # 'Path.modified'. Otherwise return None.
+        def common_module(self, filename, ext):
+            if not Options.output_common_module:
+                return None
+
+            output_dir = os.path.abspath(Options.output_directory)
+
+            return CommonModule(Path(Options.output_common_module).modified(
+                dirname=output_dir, filename=filename, ext=ext))
+
+        # Write out all sections added to 'common' so far, by this or any
+        # previously wrapped input file.
+        def output_common_module(self, common, prologue, epilogue=None):
+            common_file = self.output_file(common.path())
+
+            common_file.append(prologue)
+
+            for section in common.sections():
+                common_file.append(section)
+
+            if epilogue is not None:
+                common_file.append(epilogue)
+
+        # If '--output-pch' is given, place 'includes' in a prefix header
+        # suitable for precompilation and return an include directive for
+        # that header (which must come first in any source file using it).
+        # Additionally, a CMake file '{filename}.cmake' is created which
+        # contains a function that enables this PCH for the C++ sources of a
+        # given target (which may also contain e.g. C sources). The header is
+        # located relative to the CMake file so that no absolute paths end up
+        # in the output.
+        def output_pch(self, output_path, includes):
+            if not Options.output_pch:
+                return includes
+
+            pch = self.output_file(output_path)
+
+            header_guard = f"GUARD_{pch.filename().upper()}_H"
+
+            pch.append(code(
+                """
+                #ifndef {header_guard}
+                #define {header_guard}
+
+                {includes}
+
+                #endif // {header_guard}
+                """,
+                header_guard=header_guard,
+                includes=includes))
+
+            recipe = self.output_file(output_path.modified(ext='.cmake'))
+
+            recipe.append(code(
+                """
+                # Precompile '{pch_basename}' for all C++ sources of a target, e.g.:
+                #
+                #   include({recipe_basename})
+                #   {function}(my_bindings)
+                #
+                # Without CMake, the header can be precompiled manually, e.g.:
+                #
+                #   clang++ -x c++-header {pch_basename} -o {pch_basename}.pch
+                #   clang++ -include-pch {pch_basename}.pch -c ...
+
+                set({directory} "${{CMAKE_CURRENT_LIST_DIR}}")
+
+                function({function} target)
+                  target_precompile_headers(${{target}} PRIVATE
+                    "$<$<COMPILE_LANGUAGE:CXX>:${{{directory}}}/{pch_basename}>")
+                endfunction()
+                """,
+                pch_basename=pch.basename(),
+                recipe_basename=recipe.basename(),
+                directory=f"cppbind_{pch.filename()}_dir",
+                function=f"cppbind_{pch.filename()}"))
+
+            return pch.include()
+
+        # Split an output source file into '--output-shards' shards, if more
+        # than one shard is requested, shards are named '{filename}_{i}' and
+        # additionally listed in a manifest file named '{filename}.shards'.
+        def output_shards(self, output_path):
+            if Options.output_shards == 1:
+                return FileShards([self.output_file(output_path)])
+
+            shards = [
+                self.output_file(output_path.modified(filename=f'{{filename}}_{i}'))
+                for i in range(Options.output_shards)
+            ]
+
+            manifest = self.output_file(output_path.modified(ext='.shards'))
+            manifest.append('\n'.join(shard.basename() for shard in shards))
+
+            return FileShards(shards)
+
         def namespaces(self):
-            return self._namespaces
+            return self._analysis.namespaces()
 
         def types(self):
-            return sorted(self._types)
+            return self._analysis.types()
 
+        # Aliases whose target type names differ from those of the types they
+        # alias, this must only be called once the backend has been patched.
         def type_aliases(self):
             if self._type_aliases_target is None:
-                self._type_aliases_target = set()
-                for a, t in self._type_aliases:
-                    if a.target() != t.target():
-                        self._type_aliases_target.add((a, t))
-
-                self._type_aliases_target = list(sorted(self._type_aliases_target))
+                self._type_aliases_target = [
+                    (a, t) for a, t in self._analysis.type_aliases()
+                    if a.target() != t.target()
+                ]
 
-            return self._type_aliases_target
+            return self._type_aliases_target[:]
 
         def macros(self):
             return self._macros
@@ -292,39 +499,17 @@ def Backend(be):
         # for which definitions are available, if which == 'used' only include
         # those for which only declarations are available.
         def record_types(self, which='all'):
-            types_all = set()
-            types_defined = set()
+            return self._analysis.record_types(which)
 
-            def add_record_type(t, which):
-                if which == 'all':
-                    types_all.add(t)
-                elif which == 'defined':
-                    types_defined.add(t)
-
-            for t in self.types():
-                if t.is_alias():
-                    t = t.canonical()
-
-                if t.is_record():
-                    add_record_type(t.without_const(), 'all')
-                elif t.is_record_indirection():
-                    add_record_type(t.pointee().without_const(), 'all')
-
-            for r in self.records():
-                add_record_type(r.type(), 'defined')
-
-            types_used = types_all - types_defined
-
-            if which == 'all':
-                types = types_all
-            elif which == 'defined':
-                types = types_defined
-            elif which == 'used':
-                types = types_used
+        # Generate all output files, this is only done once per backend
+        # instance, i.e. when several backends are run which all rely on the
+        # same intermediate backend the latter is only run once.
+        def run(self):
+            if self._finished:
+                return self.output_paths()
 
-            return sorted(types)
+            self._finished = True
 
-        def run(self):
             self.wrap_before()
 
             for m in self._macros:
@@ -347,6 +532,11 @@ def Backend(be):
             for output_file in self._output_files:
                 output_file.write()
 
+            return self.output_paths()
+
+        def output_paths(self):
+            return [output_file.path() for output_file in self._output_files]
+
         def wrap_before(self):
             pass
 
@@ -392,6 +582,105 @@ def run_backend(be):
     return backend().run()
 
 
+# Run several backends and return a dictionary mapping each of them to the list
+# of files it generated. If '--backend-parallel' is given, backends are run in
+# forked worker processes which share the wrapper copy-on-write, backends that
+# depend on each other are always run by the same worker.
+def run_backends(bes):
+    groups = _backend_groups(bes)
+
+    if not Options.backend_parallel or len(groups) < 2:
+        return {be: run_backend(be) for be in bes}
+
+    workers = [_fork_backend_worker(group) for group in groups]
+
+    outputs = {}
+    errors = []
+
+    for pid, fd in workers:
+        with os.fdopen(fd, 'rb') as f:
+            report = f.read()
+
+        _, status = os.waitpid(pid, 0)
+
+        try:
+            result, common_sections = pickle.loads(report)
+        except Exception:
+            result, common_sections = None, []
+
+        if result is None or status != 0:
+            errors.append(result if isinstance(result, str) else
+                          f"backend worker {pid} terminated abnormally")
+        else:
+            outputs.update(result)
+
+            # Common module sections must survive the worker since later
+            # input files build on them.
+            common_module.replay(common_sections)
+
+    if errors:
+        raise RuntimeError('\n'.join(errors))
+
+    return {be: outputs[be] for be in bes}
+
+
+def _backend_groups(bes):
+    global _state
+
+    groups = []
+
+    for be in bes:
+        if be not in _state.impls:
+            raise ValueError(f"backend '{be}' does not exist")
+
+        related = {be, *_state.impls[be].DEPENDENCIES}
+
+        merged = [be]
+        for group in groups[:]:
+            if related & set(group) or be in chain(
+                *(_state.impls[other].DEPENDENCIES for other in group)):
+                groups.remove(group)
+                merged = group + merged
+
+        groups.append(merged)
+
+    return groups
+
+
+def _fork_backend_worker(group):
+    r, w = os.pipe()
+
+    sys.stdout.flush()
+    sys.stderr.flush()
+
+    pid = os.fork()
+
+    if pid != 0:
+        os.close(w)
+        return pid, r
+
+    # Never return from the worker, in particular don't run any interpreter or
+    # C++ cleanup code which belongs to the parent process.
+    os.close(r)
+
+    exitcode = 0
+
+    try:
+        result = {be: run_backend(be) for be in group}
+    except BaseException:
+        result = f"in backend(s) '{', '.join(group)}':\n{traceback.format_exc()}"
+        exitcode = 1
+
+    try:
+        with os.fdopen(w, 'wb') as f:
+            f.write(pickle.dumps((result, common_module.added())))
+
+        sys.stdout.flush()
+        sys.stderr.flush()
+    finally:
+        os._exit(exitcode)
+
+
 # Same as 'use_backend' but wrapped in a context manager.
 class switch_backend:
     def __init__(self, be):
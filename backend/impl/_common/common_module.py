@@ -0,0 +1,46 @@
+# Common modules (see '--output-common-module'). Types shared between several
+# input files are emitted into a single common module per backend instead of
+# once per input file. Common modules accumulate sections over all input files
+# wrapped by the same CPPBind invocation and are rewritten in full after each
+# of them, so they are complete once the last input file has been wrapped.
+
+from pycppbind import CommonModule as _Registry
+
+
+# Sections added by the current process, needed to hand them back to the
+# parent process when running backends in parallel worker processes.
+_added = []
+
+
+def added():
+    return _added[:]
+
+
+def replay(sections):
+    for path, key, section in sections:
+        _Registry.add(path, key, section)
+
+
+class CommonModule:
+    def __init__(self, path):
+        self._path = path
+
+    def path(self):
+        return self._path
+
+    def include(self):
+        return self._path.include()
+
+    # Add a section identified by 'key', returns False if a section with the
+    # same key has already been added by some input file and raises if that
+    # section differs from 'section'.
+    def add(self, key, section):
+        if not _Registry.add(self._path.path(), key, section):
+            return False
+
+        _added.append((self._path.path(), key, section))
+
+        return True
+
+    def sections(self):
+        return _Registry.sections(self._path.path())
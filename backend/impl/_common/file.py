@@ -1,7 +1,10 @@
 from copy import deepcopy
 from pycppbind import Include, Options
-from text import compress
+from text import Compressor
+import filecmp
+import hashlib
 import os
+import zlib
 
 
 class Path:
@@ -62,11 +65,30 @@ class Path:
         return new_path
 
 
+# Output file. Appended content is compressed incrementally (see
+# 'text.compress') and streamed into a temporary file next to the final output
+# file in chunks so that generated files never have to be held in memory as a
+# whole. Only prepended content, which is assumed to be small, is kept in
+# memory until the file is written.
 class File:
+    FLUSH_SIZE = 1 << 20
+
+    # Line comment syntax by extension, generated files not listed here are
+    # C, C++ or Rust. Files without comment syntax (e.g. shard manifests, which
+    # are read as whitespace separated lists) are never hashed.
+    LINE_COMMENTS = {'.cmake': '#', '.shards': None}
+
     def __init__(self, path):
-        self._content = []
         self._path = path
 
+        self._prefix = []
+
+        self._tmp = None
+        self._compressor = Compressor(self._buffer)
+        self._buffered = []
+        self._buffered_size = 0
+        self._empty = True
+
     def path(self):
         return self._path.path()
 
@@ -89,14 +111,156 @@ class File:
         return self._path.include(system)
 
     def append(self, txt, end='\n'):
-        self._content.append(txt + end)
+        if not self._empty:
+            self._compressor.feed('\n')
+
+        self._compressor.feed(txt + end)
+
+        self._empty = False
 
     def prepend(self, txt, end='\n'):
-        self._content.insert(0, txt + end)
+        self._prefix.insert(0, txt + end)
 
     def write(self):
         try:
-            with open(self._path.path(), 'w') as f:
-                f.write(compress('\n'.join(self._content)))
+            self._compressor.close()
+            self._flush()
+
+            if self._tmp is None:
+                self._open_tmp()
+
+            self._tmp.close()
+
+            tmp_path = self._tmp.name
+
+            if self._prefix:
+                self._write_with_prefix(self._tmp_prefixed_path())
+                tmp_path = self._tmp_prefixed_path()
+
+            if Options.output_content_hash and self._line_comment() is not None:
+                self._write_with_content_hash(tmp_path, self._tmp_hashed_path())
+                tmp_path = self._tmp_hashed_path()
+
+            self._replace(tmp_path)
+
         except Exception as e:
             raise ValueError(f"while dumping output file: {e}")
+
+        finally:
+            if self._tmp is not None:
+                for tmp_path in self._tmp.name, \
+                                self._tmp_prefixed_path(), \
+                                self._tmp_hashed_path():
+                    if os.path.exists(tmp_path):
+                        os.remove(tmp_path)
+
+    # Move a finished temporary file into place. With '--output-incremental'
+    # an existing output file with identical content is left untouched so that
+    # its modification time is preserved and build systems don't recompile it.
+    def _replace(self, tmp_path):
+        if Options.output_incremental and \
+           os.path.exists(self.path()) and \
+           filecmp.cmp(tmp_path, self.path(), shallow=False):
+            return
+
+        os.replace(tmp_path, self.path())
+
+    def _buffer(self, txt):
+        self._buffered.append(txt)
+        self._buffered_size += len(txt)
+
+        if self._buffered_size >= self.FLUSH_SIZE:
+            self._flush()
+
+    def _flush(self):
+        if not self._buffered:
+            return
+
+        if self._tmp is None:
+            self._open_tmp()
+
+        self._tmp.write(''.join(self._buffered))
+
+        self._buffered = []
+        self._buffered_size = 0
+
+    def _open_tmp(self):
+        tmp_path = os.path.join(self.dirname(), f'.{self.basename()}.tmp')
+
+        self._tmp = open(tmp_path, 'w')
+
+    def _tmp_prefixed_path(self):
+        return f'{self._tmp.name}.prefixed'
+
+    def _tmp_hashed_path(self):
+        return f'{self._tmp.name}.hashed'
+
+    def _line_comment(self):
+        return self.LINE_COMMENTS.get(self.ext(), '//')
+
+    # Copy the file at 'src_path' to 'path', preceded by a comment containing
+    # a hash of its content (see '--output-content-hash').
+    def _write_with_content_hash(self, src_path, path):
+        content_hash = hashlib.sha256()
+
+        with open(src_path, 'rb') as src:
+            for chunk in iter(lambda: src.read(self.FLUSH_SIZE), b''):
+                content_hash.update(chunk)
+
+        with open(src_path, 'rb') as src, open(path, 'wb') as f:
+            f.write(f'{self._line_comment()} cppbind-content-hash: '
+                    f'sha256:{content_hash.hexdigest()}\n'.encode())
+
+            for chunk in iter(lambda: src.read(self.FLUSH_SIZE), b''):
+                f.write(chunk)
+
+    def _write_with_prefix(self, path):
+        with open(path, 'w') as f:
+            compressor = Compressor(f.write)
+
+            compressor.feed('\n'.join(self._prefix))
+
+            if not self._empty:
+                compressor.feed('\n' + self._compressor.leading)
+
+                with open(self._tmp.name, 'r') as tmp:
+                    for chunk in iter(lambda: tmp.read(self.FLUSH_SIZE), ''):
+                        compressor.feed(chunk)
+
+            compressor.close()
+
+
+# Set of output files ("shards") between which independent snippets (e.g.
+# function definitions) are distributed such that the shards end up being of
+# roughly equal size. This allows generated code to be compiled in parallel.
+#
+# With '--output-incremental', snippets appended together with a key naming the
+# entity they belong to are instead always placed in the same shard, determined
+# by a stable hash of that key. A change to the definition of a single entity
+# then only changes a single shard and the remaining shards are not rewritten
+# (see 'File._replace'). This does not hold for changes to declarations, e.g.
+# of function signatures, since all shards include a common header declaring
+# all entities.
+class FileShards:
+    def __init__(self, files):
+        self._files = files
+        self._sizes = [0] * len(files)
+
+    def files(self):
+        return self._files
+
+    def is_sharded(self):
+        return len(self._files) > 1
+
+    def append(self, txt, end='\n', key=None):
+        if key is not None and Options.output_incremental:
+            i = zlib.crc32(key.encode()) % len(self._files)
+        else:
+            i = min(range(len(self._files)), key=self._sizes.__getitem__)
+
+        self._files[i].append(txt, end)
+        self._sizes[i] += len(txt)
+
+    def append_each(self, txt, end='\n'):
+        for f in self._files:
+            f.append(txt, end)
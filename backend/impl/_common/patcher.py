@@ -11,6 +11,33 @@ from text import code
 from util import dotdict
 
 
+# Formatting names involves several calls into CPPBind and the same names are
+# requested over and over again, so they are cached per object (where an object
+# allows setting attributes). Names also depend on the currently active patches
+# (e.g. 'Id.reserved'), so the caches are invalidated whenever those change.
+_name_cache_generation = 0
+
+
+def _invalidate_name_caches():
+    global _name_cache_generation
+
+    _name_cache_generation += 1
+
+
+def _name_cache(obj):
+    attrs = getattr(obj, '__dict__', None)
+    if attrs is None:
+        return None
+
+    cache = attrs.get('_name_cache')
+
+    if cache is None or cache[0] != _name_cache_generation:
+        cache = (_name_cache_generation, {})
+        attrs['_name_cache'] = cache
+
+    return cache[1]
+
+
 def _name(get=lambda self: self.name(),
           default_namespace='keep',
           default_case=Id.SNAKE_CASE,
@@ -25,6 +52,12 @@ def _name(get=lambda self: self.name(),
                      prefix=default_prefix,
                      postfix=default_postfix):
 
+        cache = _name_cache(self)
+        key = (name_closure, namespace, case, quals, prefix, postfix)
+
+        if cache is not None and key in cache:
+            return cache[key]
+
         name = get(self)
 
         if namespace == 'remove' and self.namespace() is not None:
@@ -41,6 +74,9 @@ def _name(get=lambda self: self.name(),
         while name in Id.reserved():
             name += '_'
 
+        if cache is not None:
+            cache[key] = name
+
         return name
 
     return name_closure
@@ -284,6 +320,69 @@ def _function_perform_return(self):
     return
 
 
+# Wrapper functions whose parameters and return values need no translation
+# beyond implicit conversions (or those performed by the converters in the
+# backend runtime headers) can be forwarded to generic call thunks instead of
+# being generated in full. This returns a pointer to the wrapped function
+# suitable as template argument for such thunks or None if the function does
+# not qualify.
+def _function_thunk_pointer(self):
+    if not Options.wrap_call_thunks:
+        return
+
+    if self.custom_action() is not None or \
+       self.is_constructor() or \
+       self.is_destructor() or \
+       self.is_overloaded_operator() or \
+       self.is_base_cast() or \
+       self.is_custom_cast():
+        return
+
+    def supported(t):
+        if t.is_enum():
+            return False
+
+        return t.is_boolean() or t.is_integral() or t.is_floating() or t.is_c_string()
+
+    return_type = self.return_type()
+
+    if not (return_type.is_void() or supported(return_type)):
+        return
+
+    parameters = [p for p in self.parameters() if not p.is_self()]
+
+    for p in parameters:
+        if p.default_argument() is not None or not supported(p.type()):
+            return
+
+    parameter_types = ', '.join(str(p.type()) for p in parameters)
+
+    function = f"{self.name()}"
+
+    if self.is_instance():
+        if self.parent().is_abstract():
+            return
+
+        # Inherited member functions are pointed to as members of the base
+        # class declaring them, pointers to members of virtual base classes
+        # can't be converted to pointers to members of derived classes.
+        origin = self.origin().type()
+
+        pointer_type = f"{return_type} ({origin}::*)({parameter_types})"
+
+        if self.is_const():
+            pointer_type = f"{pointer_type} const"
+
+        function = f"{origin}::{self.name().format(quals=Id.REMOVE_QUALS)}"
+    else:
+        pointer_type = f"{return_type} (*)({parameter_types})"
+
+    if self.template_argument_list():
+        function = f"{function}{self.template_argument_list()}"
+
+    return f"static_cast<{pointer_type}>(&{function})"
+
+
 def _function_forward(self):
     forward = code(
         """
@@ -380,6 +479,7 @@ class Patcher:
         Function.declare_return_value = _function_declare_return_value
         Function.forward_return_value = _function_forward_return_value
         Function.perform_return = _function_perform_return
+        Function.thunk_pointer = _function_thunk_pointer
         Function.forward = _function_forward
         Function.can_throw = _function_can_throw
         Function.try_catch = _function_try_catch
@@ -417,6 +517,8 @@ class Patcher:
 
         setattr(cls, attr, fn)
 
+        _invalidate_name_caches()
+
     @abstractmethod
     def patch(self):
         pass
@@ -427,3 +529,5 @@ class Patcher:
                 delattr(cls, attr)
             else:
                 setattr(cls, attr, fn)
+
+        _invalidate_name_caches()
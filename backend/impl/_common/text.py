@@ -2,75 +2,151 @@
 
 import re
 import textwrap
-from functools import partial
+from functools import lru_cache, partial
 from itertools import groupby
 
 
 # This function formats source code such that indentation is preserved, usage
 # is similar to .format, e.g.: code('hello {name}', name='timo')
 def code(c, **kwargs):
-    c = textwrap.dedent(c).strip()
+    if not kwargs:
+        return _dedent(c)
 
-    if kwargs:
-        c = _format(c, kwargs)
+    none_kws = tuple(kw for kw, arg in kwargs.items() if arg is None)
 
-    return c
+    return _compile(c, none_kws).format(kwargs)
 
 
 # "Compresses" adjacent empty lines into one.
 def compress(txt):
-    txt_lines = [l.rstrip() for l in txt.strip().split('\n')]
+    compressed = []
 
-    group_if = lambda xs, cond: ([k] if cond(k) else list(g)
-                                 for k, g in groupby(xs))
+    compressor = Compressor(compressed.append)
+    compressor.feed(txt)
+    compressor.close()
 
-    flatten = lambda xs: [x for xs_sub in xs for x in xs_sub]
+    return ''.join(compressed)
 
-    compressed = group_if(txt_lines, cond=lambda k: not k)
 
-    return '\n'.join(flatten(compressed))
+# Incremental version of 'compress', text can be passed to 'feed' in arbitrary
+# pieces and compressed text is passed on to 'write' as soon as it is known to
+# be final. Only the current incomplete line and whether the last complete line
+# was empty is retained in between. Afterwards, 'leading' holds (the compressed
+# equivalent of) the whitespace stripped from the beginning of the text.
+class Compressor:
+    def __init__(self, write):
+        self._write = write
 
+        self._partial = ''
+        self._started = False
+        self._blank = False
 
-def _format(txt, kwargs):
-    txt_lines = txt.split('\n')
+        self.leading = ''
 
-    _format_process_kwargs(txt_lines, kwargs)
+    def feed(self, txt):
+        lines = (self._partial + txt).split('\n')
 
-    return '\n'.join(txt_lines).format(**kwargs)
+        self._partial = lines.pop()
 
+        for l in lines:
+            self._line(l)
 
-def _format_process_kwargs(txt_lines, kwargs):
-    for kw, arg in kwargs.items():
-        if isinstance(arg, str):
-            arg = arg.strip()
+    def close(self):
+        self._line(self._partial)
 
-            if arg.count('\n') > 0:
-                kwargs[kw] = _format_multiline_arg(txt_lines, kw, arg)
+        self._partial = ''
 
-        elif arg is None:
-            kwargs[kw] = _format_none_arg(txt_lines, kw, arg)
+    def _line(self, l):
+        l = l.rstrip()
 
+        if not l:
+            if not self._started:
+                self.leading = '\n'
 
-def _format_multiline_arg(txt_lines, kw, arg):
-    # XXX multiple occurrences
+            self._blank = self._started
+            return
 
-    ind = None
-    for l in txt_lines:
-        m = re.match(f'( *){{{kw}}}', l)
+        if self._started:
+            self._write('\n\n' if self._blank else '\n')
+        else:
+            self.leading += l[:len(l) - len(l.lstrip())]
 
-        if m is not None:
-            ind = m[1]
-            break
+            l = l.lstrip()
 
-    if ind is None:
-        return
+        self._write(l)
 
-    arg_line_first, arg_lines_rest = arg.split('\n', maxsplit=1)
+        self._started = True
+        self._blank = False
 
-    return '\n'.join([arg_line_first, textwrap.indent(arg_lines_rest, ind)])
 
+# Templates are typically formatted many times over so all of the work that
+# does not depend on the actual arguments (dedenting, removing placeholders for
+# 'None' arguments, determining the indentation of placeholders for multi-line
+# arguments) is only performed once per template. Many templates are f-strings
+# so the caches are bounded.
+_TEMPLATE_CACHE_SIZE = 4096
 
-def _format_none_arg(txt_lines, kw, arg):
-    txt_lines[:] = [l.replace(f'{{{kw}}}', '') for l in txt_lines]
 
-    return arg
+@lru_cache(maxsize=_TEMPLATE_CACHE_SIZE)
+def _dedent(c):
+    return textwrap.dedent(c).strip()
+
+
+@lru_cache(maxsize=_TEMPLATE_CACHE_SIZE)
+def _compile(c, none_kws):
+    return _Template(_dedent(c), none_kws)
+
+
+class _Template:
+    def __init__(self, txt, none_kws):
+        txt_lines = txt.split('\n')
+
+        for kw in none_kws:
+            txt_lines = [l.replace(f'{{{kw}}}', '') for l in txt_lines]
+
+        self._txt = '\n'.join(txt_lines)
+        self._txt_lines = txt_lines
+        self._indentation = {}
+
+    def format(self, kwargs):
+        for kw, arg in kwargs.items():
+            if isinstance(arg, str) and '\n' in arg:
+                arg = arg.strip()
+
+                if '\n' in arg:
+                    kwargs[kw] = self._format_multiline_arg(kw, arg)
+
+        return self._txt.format(**kwargs)
+
+    def _format_multiline_arg(self, kw, arg):
+        # XXX multiple occurrences
+
+        ind = self._find_indentation(kw)
+
+        if ind is None:
+            return
+
+        arg_line_first, arg_lines_rest = arg.split('\n', maxsplit=1)
+
+        arg_lines_rest = '\n'.join(ind + l if l.strip() else l
+                                   for l in arg_lines_rest.split('\n'))
+
+        return f'{arg_line_first}\n{arg_lines_rest}'
+
+    def _find_indentation(self, kw):
+        try:
+            return self._indentation[kw]
+        except KeyError:
+            pass
+
+        ind = None
+        for l in self._txt_lines:
+            m = re.match(f'( *){{{kw}}}', l)
+
+            if m is not None:
+                ind = m[1]
+                break
+
+        self._indentation[kw] = ind
+
+        return ind
@@ -28,7 +28,12 @@ def path():
 
 
 # Create 'type_instance' instantiations for all record and reference types used
-# by wrapper functions in the current translation unit.
+# by wrapper functions in the current translation unit, returns a list of
+# triples of mangled type names, declarations and definitions. Declarations
+# also specialize 'instance_of' so that 'type::get' resolves these types at
+# compile time, they must precede all code using them. Non-virtual base types
+# are described by their offset within the derived type, which is known here
+# (see 'Type.base_offset').
 def type_instances():
     be_records = backend().records(include_declarations=True)
 
@@ -64,28 +69,74 @@ def type_instances():
         elif t.is_pointer() or t.is_reference():
             add_type(t.pointee())
 
+    def base(t, t_base):
+        offset = t.base_offset(t_base)
+
+        if offset is None:
+            return f"virtual_base<{t_base}>"
+
+        return f"base<{t_base}, {offset}>"
+
     tis = []
     for t_mangled, t, t_bases in types.values():
-        template_params = [t]
+        template_params = [str(t)]
 
         if t_bases is not None:
-            template_params += t_bases
+            template_params += [base(t, t_base) for t_base in t_bases]
 
-        template_params = ', '.join(map(str, template_params))
+        ti = f"type_instance<{', '.join(template_params)}> const {t_mangled};"
 
-        tis.append(f"type_instance<{template_params}> {t_mangled};")
+        tis.append((t_mangled,
+                    f"extern {ti}\n"
+                    f"template<> inline constexpr type const *instance_of<{t}> = &{t_mangled};",
+                    ti))
 
-    if not tis:
+    return tis
+
+
+def _in_namespace(definitions):
+    if not definitions:
         return
 
     return code(
         """
         namespace {ns} {{
-          {tis}
+          {definitions}
         }}
         """,
         ns=_NS,
-        tis='\n'.join(tis))
+        definitions='\n'.join(definitions))
+
+
+# Declarations of type instances (see 'type_instances'), wrapped in the
+# 'type_info' namespace.
+def type_instance_declarations(tis):
+    return _in_namespace([declaration for _, declaration, _ in tis])
+
+
+# Definitions of type instances (see 'type_instances'), wrapped in the
+# 'type_info' namespace, their declarations must precede them.
+def type_instance_definitions(tis):
+    return _in_namespace([definition for _, _, definition in tis])
+
+
+# Table of type instances registered with the type registry while a module is
+# loaded, must be placed in the module's main source file.
+def type_table(tis):
+    if not tis:
+        return
+
+    return _in_namespace([code(
+        """
+        namespace {{
+          type const *const _types[] = {{
+            {types}
+          }};
+
+          type_table const _type_table(_types);
+        }}
+        """,
+        types=',\n'.join(f"&{t_mangled}" for t_mangled, _, _ in tis))])
 
 
 def make_typed(arg, mem=None, owning=False):
@@ -73,6 +73,12 @@ class RuleLookup:
     def __init__(self):
         self._lookup = {}
 
+        # Matching a type against a list of rules can involve a lot of calls
+        # into CPPBind so the results are cached per action and type. Types
+        # compare equal iff their (qualified) spellings are equal so a type's
+        # qualifiers are automatically part of the key.
+        self._cache = {}
+
         # This should be set to 'custom' before a custom type translation rules
         # module is imported (see below). Custom type translation rules are
         # maintained separately and given priority over default ones.
@@ -91,7 +97,22 @@ class RuleLookup:
 
         self._lookup[action.__name__][self.mode].append(rule)
 
+        self.invalidate()
+
+    def invalidate(self):
+        self._cache.clear()
+
     def find_rule(self, type_instance, action):
+        key = (action.__name__, type_instance)
+
+        rule = self._cache.get(key)
+        if rule is None:
+            rule = self._find_rule(type_instance, action)
+            self._cache[key] = rule
+
+        return rule
+
+    def _find_rule(self, type_instance, action):
         if action.__name__ not in self._lookup:
             raise RuntimeError(f"no '{action.__name__}' rule")
 
@@ -155,6 +176,8 @@ def TypeTranslator(be):
             from importlib import import_module
             import_module(custom_rules_mod)
 
+            cls._rule_lookup.invalidate()
+
     class TypeTranslatorGeneric(metaclass=TypeTranslatorMeta):
         _rule_lookup = RuleLookup()
 
@@ -23,9 +23,34 @@ class CBackend(Backend('c')):
         self._wrapper_header = self.output_file(
             self.input_file().modified(filename='{filename}_c', ext='c-header'))
 
-        self._wrapper_source = self.output_file(
+        self._wrapper_source = self.output_shards(
             self.input_file().modified(filename='{filename}_c', ext='cpp-source'))
 
+        self._common = self.common_module(filename='{filename}_c', ext='c-header')
+
+        if self._common is None:
+            header_types = code(
+                """
+                {typedefs}
+
+                {record_declarations}
+
+                {record_definitions}
+                """,
+                typedefs='\n'.join(self._typedefs()),
+                record_declarations='\n'.join(self._record_declarations()),
+                record_definitions='\n\n'.join(self._record_definitions_header()))
+        else:
+            # Typedefs and all record definitions, including those of records
+            # only declared in the input file, move to the common header.
+            for a, t in self.type_aliases():
+                self._common.add(f"typedef:{a.target()}", self._typedef(a, t))
+
+            for t in self._record_types():
+                self._common.add(f"record:{t.mangled()}", self._record_definition(t))
+
+            header_types = self._common.include()
+
         self._wrapper_header.append(code(
             """
             #ifndef {header_guard}
@@ -37,18 +62,12 @@ class CBackend(Backend('c')):
 
             #include "cppbind/c/c_bind_error_c.h"
 
-            {typedefs}
-
-            {record_declarations}
-
-            {record_definitions}
+            {header_types}
             """,
             header_guard=self._header_guard(),
-            typedefs='\n'.join(self._typedefs()),
-            record_declarations='\n'.join(self._record_declarations()),
-            record_definitions='\n\n'.join(self._record_definitions_header())))
+            header_types=header_types))
 
-        self._wrapper_source.append(code(
+        source_includes = code(
             """
             #include <cassert>
             #include <cerrno>
@@ -60,16 +79,68 @@ class CBackend(Backend('c')):
             #include "cppbind/c/c_util_cc.h"
 
             {input_includes}
+            """,
+            input_includes='\n'.join(self.input_includes()))
 
-            extern "C" {{
+        source_includes = self.output_pch(
+            self.input_file().modified(filename='{filename}_c_pch', ext='cpp-header'),
+            source_includes)
 
+        source_definitions = code(
+            """
             {input_header_include}
 
             {record_definitions}
             """,
-            input_includes='\n'.join(self.input_includes()),
             input_header_include=self._wrapper_header.include(),
-            record_definitions='\n\n'.join(self._record_definitions_source())))
+            record_definitions='\n\n'.join(self._record_definitions_source())
+                               if self._common is None else '')
+
+        if not self._wrapper_source.is_sharded():
+            self._wrapper_source.append_each(code(
+                """
+                {source_includes}
+
+                extern "C" {{
+
+                {source_definitions}
+                """,
+                source_includes=source_includes,
+                source_definitions=source_definitions))
+
+            return
+
+        # Everything but the function definitions themselves lives in a common
+        # header included by all shards.
+        wrapper_source_common = self.output_file(
+            self.input_file().modified(filename='{filename}_c_common', ext='cpp-header'))
+
+        wrapper_source_common.append(code(
+            """
+            #ifndef {header_guard}
+            #define {header_guard}
+
+            {source_includes}
+
+            extern "C" {{
+
+            {source_definitions}
+
+            }} // extern "C"
+
+            #endif // {header_guard}
+            """,
+            header_guard=self._header_guard('C_COMMON'),
+            source_includes=source_includes,
+            source_definitions=source_definitions))
+
+        self._wrapper_source.append_each(code(
+            """
+            {common_include}
+
+            extern "C" {{
+            """,
+            common_include=wrapper_source_common.include()))
 
     def wrap_after(self):
         self._wrapper_header.append(code(
@@ -82,11 +153,34 @@ class CBackend(Backend('c')):
             """,
             header_guard=self._header_guard()))
 
-        self._wrapper_source.append(code(
+        self._wrapper_source.append_each(code(
             """
             } // extern "C"
             """))
 
+        if self._common is not None:
+            self.output_common_module(
+                self._common,
+                code(
+                    """
+                    #ifndef {header_guard}
+                    #define {header_guard}
+
+                    #ifdef __cplusplus
+                    extern "C" {{
+                    #endif
+                    """,
+                    header_guard=self._common_header_guard()),
+                code(
+                    """
+                    #ifdef __cplusplus
+                    }} // extern "C"
+                    #endif
+
+                    #endif // {header_guard}
+                    """,
+                    header_guard=self._common_header_guard()))
+
     def wrap_enum(self, e):
         enum_constants = [f"{c.name_target()} = {c.value(as_c_literal=True)}"
                           for c in e.constants()]
@@ -110,27 +204,27 @@ class CBackend(Backend('c')):
 
     def wrap_function(self, f):
         self._wrapper_header.append(self._function_declaration(f))
-        self._wrapper_source.append(self._function_definition(f))
+        self._wrapper_source.append(self._function_definition(f), key=f.name_target())
 
     def wrap_record(self, r):
         for f in r.functions():
             self.wrap_function(f)
 
-    def _header_guard(self):
+    def _header_guard(self, which='C'):
         guard_id = self.input_file().filename().upper()
 
-        return f"GUARD_{guard_id}_C_H"
+        return f"GUARD_{guard_id}_{which}_H"
 
-    def _typedefs(self):
-        typedefs = []
-        for a, t in self.type_aliases():
-            a_target = a.target()
-            t_target = t.target()
+    def _common_header_guard(self):
+        guard_id = self._common.path().filename().upper()
+
+        return f"GUARD_{guard_id}_H"
 
-            if a_target != t_target:
-                typedefs.append(f"typedef {t_target} {a_target};")
+    def _typedefs(self):
+        return [self._typedef(a, t) for a, t in self.type_aliases()]
 
-        return typedefs
+    def _typedef(self, a, t):
+        return f"typedef {t.target()} {a.target()};"
 
     def _function_declaration(self, f):
         header = self._function_header(f)
@@ -182,7 +276,20 @@ class CBackend(Backend('c')):
         return f"{return_type} {name}({parameters})"
 
     def _function_body(self, f):
-        return f.forward()
+        thunk = f.thunk_pointer()
+
+        if thunk is None:
+            return f.forward()
+
+        args = []
+
+        for p in f.parameters():
+            if p.is_self():
+                args.append(c_util.struct_cast(p.type().pointee(), p.name_target()))
+            else:
+                args.append(p.name_target())
+
+        return f"return {c_util.invoke(thunk, args)};"
 
     def _record_types(self, which='all'):
         return [t for t in self.record_types(which) if t.target().startswith('struct')]
@@ -10,6 +10,7 @@ MAKE_OWNING_STRUCT_ARGS = f"{_NS}::make_owning_struct_args"
 MAKE_NON_OWNING_STRUCT = f"{_NS}::make_non_owning_struct"
 STRUCT_CAST = f"{_NS}::struct_cast"
 NON_OWNING_STRUCT_CAST = f"{_NS}::non_owning_struct_cast"
+INVOKE = f"{_NS}::invoke"
 
 
 def make_owning_struct_mem(s, t, mem):
@@ -33,3 +34,7 @@ def struct_cast(t, what):
 
 def non_owning_struct_cast(t, what):
     return f"{NON_OWNING_STRUCT_CAST}<{t}>({what})"
+
+
+def invoke(f, args):
+    return f"{INVOKE}<{f}>({', '.join(args)})"
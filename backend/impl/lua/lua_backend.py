@@ -1,6 +1,7 @@
 import lua_util
 import type_info
 from backend import Backend
+from file import FileShards
 from lua_patcher import LuaPatcher
 from lua_type_translator import LuaTypeTranslator
 from pycppbind import Enum, Function, Identifier as Id, Options, Record, Type
@@ -24,7 +25,7 @@ class LuaBackend(Backend('lua')):
         self._wrapper_module = self.output_file(
             self.input_file().modified(filename='{filename}_lua', ext='cpp-source'))
 
-        self._wrapper_module.append(code(
+        module_includes = code(
             """
             #define LUA_LIB
 
@@ -40,19 +41,124 @@ class LuaBackend(Backend('lua')):
             {type_info_include}
 
             {input_includes}
-
-            {type_info_type_instances}
-
-            namespace
-            {{
             """,
             lua_includes=self._lua_includes(),
             lua_util_include=lua_util.path().include(),
             input_includes='\n'.join(self.input_includes()),
-            type_info_include=type_info.path().include(),
-            type_info_type_instances=type_info.type_instances()))
+            type_info_include=type_info.path().include())
+
+        module_includes = self.output_pch(
+            self.input_file().modified(filename='{filename}_lua_pch', ext='cpp-header'),
+            module_includes)
+
+        type_instances = type_info.type_instances()
+
+        if Options.output_shards == 1:
+            self._wrapper_shards = FileShards([self._wrapper_module])
+            self._wrapper_common = None
+
+            type_info_declarations = type_info.type_instance_declarations(type_instances)
+        else:
+            # Function definitions are distributed between the shards, all of
+            # which include a common header containing the module includes and
+            # declarations of all functions (which are referenced when
+            # registering the module) and type instances.
+            self._wrapper_shards = self.output_shards(
+                self.input_file().modified(filename='{filename}_lua', ext='cpp-source'))
+
+            self._wrapper_common = self.output_file(
+                self.input_file().modified(filename='{filename}_lua_common', ext='cpp-header'))
+
+            self._wrapper_common.append(code(
+                """
+                #ifndef {header_guard}
+                #define {header_guard}
+
+                {module_includes}
+
+                {type_info_declarations}
+
+                namespace {namespace}
+                {{
+                """,
+                header_guard=self._header_guard(),
+                module_includes=module_includes,
+                type_info_declarations=type_info.type_instance_declarations(type_instances),
+                namespace=self._namespace()))
+
+            self._wrapper_shards.append_each(code(
+                """
+                {common_include}
+
+                namespace {namespace}
+                {{
+                """,
+                common_include=self._wrapper_common.include(),
+                namespace=self._namespace()))
+
+            module_includes = self._wrapper_common.include()
+
+            type_info_declarations = None
+
+        self._common = self.common_module(filename='{filename}_lua', ext='cpp-source')
+
+        if self._common is None:
+            type_info_definitions = type_info.type_instance_definitions(type_instances)
+        else:
+            # Type instances are defined only once in the common module, which
+            # is compiled separately, together with the includes they depend
+            # on. Every module still registers a table of the types it uses.
+            for inc in self.input_includes():
+                self._common.add(f"include:{inc}", inc)
+
+            for ti in type_instances:
+                self._common.add(f"type:{ti[0]}", code(
+                    """
+                    {type_info_declarations}
+
+                    {type_info_definitions}
+                    """,
+                    type_info_declarations=type_info.type_instance_declarations([ti]),
+                    type_info_definitions=type_info.type_instance_definitions([ti])))
+
+            type_info_definitions = None
+
+        self._wrapper_module.append(code(
+            """
+            {module_includes}
+
+            {type_info_declarations}
+
+            {type_info_definitions}
+
+            {type_info_table}
+
+            namespace {namespace}
+            {{
+            """,
+            module_includes=module_includes,
+            type_info_declarations=type_info_declarations,
+            type_info_definitions=type_info_definitions,
+            type_info_table=type_info.type_table(type_instances),
+            namespace=self._namespace()))
 
     def wrap_after(self):
+        if self._wrapper_shards.is_sharded():
+            self._wrapper_common.append(code(
+                """
+                }} // namespace {namespace}
+
+                #endif // {header_guard}
+                """,
+                header_guard=self._header_guard(),
+                namespace=self._namespace()))
+
+            self._wrapper_shards.append_each(code(
+                """
+                }} // namespace {namespace}
+                """,
+                namespace=self._namespace()))
+
         ## XXX support different Lua versions
         self._wrapper_module.append(code(
             """
@@ -73,12 +179,16 @@ class LuaBackend(Backend('lua')):
 
             }} // extern "C"
 
-            }} // namespace
+            }} // namespace {namespace}
             """,
             lua_module_name=self._lua_module_name(),
             register_module=self._lua_module_register(),
             create_metatables=self._create_metatables(
-                r for r in self.records(include_abstract=False))))
+                r for r in self.records(include_abstract=False)),
+            namespace=self._namespace()))
+
+        if self._common is not None:
+            self.output_common_module(self._common, type_info.path().include())
 
     def wrap_definition(self, d):
         self.wrap_variable(d.as_variable())
@@ -93,7 +203,7 @@ class LuaBackend(Backend('lua')):
             self.wrap_function(v.setter())
 
     def wrap_function(self, f):
-        self._wrapper_module.append(self._function_definition(f))
+        self._wrap_functions([f], key=f.name_target())
 
     def wrap_record(self, r):
         if r.is_abstract():
@@ -101,7 +211,16 @@ class LuaBackend(Backend('lua')):
 
         functions = [f for f in r.functions() if not f.is_destructor()]
 
-        self._wrapper_module.append(self._function_definitions(functions))
+        self._wrap_functions(functions, key=r.type().mangled())
+
+    def _wrap_functions(self, functions, key):
+        if not functions:
+            return
+
+        if self._wrapper_common is not None:
+            self._wrapper_common.append(self._function_declarations(functions))
+
+        self._wrapper_shards.append(self._function_definitions(functions), key=key)
 
     def _lua_includes(self):
         lua_includes = ['lua.h', 'lauxlib.h']
@@ -129,6 +248,19 @@ class LuaBackend(Backend('lua')):
     def _lua_module_name(self):
         return self.input_file().filename()
 
+    def _header_guard(self):
+        guard_id = self.input_file().filename().upper()
+
+        return f"GUARD_{guard_id}_LUA_COMMON_H"
+
+    def _namespace(self):
+        # Sharded modules can't use an anonymous namespace since functions
+        # defined in one shard are referenced from another.
+        if Options.output_shards == 1:
+            return ''
+
+        return f"cppbind_{self._lua_module_name()}_lua"
+
     def _lua_module_register(self):
         return code(
             """
@@ -148,11 +280,24 @@ class LuaBackend(Backend('lua')):
             }}
             """,
             header=self._function_header(f),
-            body=f.forward())
+            body=self._function_body(f))
+
+    def _function_body(self, f):
+        thunk = f.thunk_pointer()
+
+        if thunk is None:
+            return f.forward()
+
+        self_type = f.parent().type() if f.is_instance() else None
+
+        return f"return {lua_util.invoke(thunk, self_type=self_type)};"
 
     def _function_definitions(self, functions):
         return '\n\n'.join(map(self._function_definition, functions))
 
+    def _function_declarations(self, functions):
+        return '\n'.join(f"{self._function_header(f)};" for f in functions)
+
     def _function_header(self, f):
         return f"int {f.name_target()}(lua_State *L)"
 
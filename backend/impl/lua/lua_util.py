@@ -21,6 +21,7 @@ PUSHINTEGRAL = f"{_NS}::pushintegral"
 PUSHINTEGRAL_CONSTEXPR = f"cppbind_lua_pushintegral_constexpr"
 PUSHFLOATING = f"{_NS}::pushfloating"
 PUSHFLOATING_CONSTEXPR = f"cppbind_lua_pushfloating_constexpr"
+INVOKE = f"{_NS}::invoke"
 
 
 def path():
@@ -94,3 +95,10 @@ def pushfloating(arg, constexpr=False):
 
 def pushpointer(arg, owning=False):
     return f"{ti.make_typed(arg, mem='lua_newuserdata(L, sizeof(cppbind::type_info::typed_ptr))', owning=owning)}"
+
+
+def invoke(f, self_type=None):
+    if self_type is None:
+        return f"{INVOKE}<{f}>(L)"
+
+    return f"{INVOKE}<{f}, {self_type}>(L)"
@@ -7,6 +7,8 @@ from text import code
 
 
 class RustBackend(Backend('rust')):
+    DEPENDENCIES = ('c',)
+
     def __init__(self, *args, **kwargs):
         super().__init__(*args, **kwargs)
 
@@ -26,6 +28,17 @@ class RustBackend(Backend('rust')):
         self._wrapper_source = self.output_file(
             self.input_file().modified(filename='{filename}_rust', ext='.rs'))
 
+        self._common = self.common_module(filename='{filename}_rust', ext='.rs')
+
+        if self._common is not None:
+            # Several wrapped input files may be included into the same
+            # scope, only one of these imports is then used.
+            self._wrapper_source.append(code(
+                f"""
+                #[allow(unused_imports)]
+                use crate::{self._common.path().filename()}::*;
+                """))
+
         self._wrapper_source.append(self._c_declarations())
 
         self._wrapper_source.append('\n'.join(self._rust_typedefs()))
@@ -63,13 +76,26 @@ class RustBackend(Backend('rust')):
     def wrap_function(self, f):
         self._wrapper_source.append(self._function_definition_rust(f))
 
+    def wrap_after(self):
+        if self._common is not None:
+            self.output_common_module(
+                self._common, code(
+                    """
+                    // Types shared by all wrapped input files, declare as a module
+                    // of the crate root.
+                    #![allow(unused_imports)]
+                    use super::*;
+                    """))
+
     def wrap_record(self, r):
         if r.type() in self.record_types():
-            env_key = 'RECORD_{}'.format(r.type().mangled())
+            key = 'RECORD_{}'.format(r.type().mangled())
 
-            if Env.get(env_key) is None:
+            if self._common is not None:
+                self._common.add(key, self._record_definition_rust(r))
+            elif Env.get(key) is None:
                 self._wrapper_source.append(self._record_definition_rust(r))
-                Env.set(env_key, 'y')
+                Env.set(key, 'y')
 
         if r.is_definition():
             if r.is_polymorphic():
@@ -83,7 +109,7 @@ class RustBackend(Backend('rust')):
         return f"{self.input_file().filename()}_c"
 
     def _c_types(self):
-        type_set = self.types()
+        type_set = set(self.types())
 
         type_set.add(Type('void'))
         type_set.add(Type('char'))
@@ -133,11 +159,14 @@ class RustBackend(Backend('rust')):
     def _rust_typedefs(self):
         typedefs = []
         for a, t in self.type_aliases():
-            env_key = 'TYPEDEF_{}'.format(a.target())
+            key = 'TYPEDEF_{}'.format(a.target())
+            typedef = f"type {a.target()} = {t.target()};"
 
-            if Env.get(env_key) is None:
-                typedefs.append(f"type {a.target()} = {t.target()};")
-                Env.set(env_key, 'y')
+            if self._common is not None:
+                self._common.add(key, f"pub {typedef}")
+            elif Env.get(key) is None:
+                typedefs.append(typedef)
+                Env.set(key, 'y')
 
         return typedefs
 
@@ -161,8 +190,8 @@ class RustBackend(Backend('rust')):
             pub struct {record_name} {{
                 obj : {record_union},
 
-                is_const: {c_char},
-                is_owning: {c_char},
+                pub(crate) is_const: {c_char},
+                pub(crate) is_owning: {c_char},
             }}
             """,
             )
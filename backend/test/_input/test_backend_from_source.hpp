@@ -0,0 +1,16 @@
+namespace test
+{
+
+inline int answer() noexcept
+{ return 42; }
+
+class Oracle
+{
+public:
+  Oracle() noexcept = default;
+
+  int get() const noexcept
+  { return answer(); }
+};
+
+} // namespace test
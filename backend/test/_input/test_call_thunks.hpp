@@ -0,0 +1,55 @@
+#include <stdexcept>
+
+namespace test
+{
+
+inline int add(int a, int b)
+{ return a + b; }
+
+inline double scale(double d, float factor)
+{ return d * factor; }
+
+inline bool negate(bool b) noexcept
+{ return !b; }
+
+inline char const *greet() noexcept
+{ return "hello"; }
+
+inline int check_positive(int i)
+{
+  if (i <= 0)
+    throw std::invalid_argument("not positive");
+
+  return i;
+}
+
+class Counter
+{
+public:
+  Counter() noexcept = default;
+
+  int count() const noexcept
+  { return _count; }
+
+  void increment(int by)
+  {
+    if (by < 0)
+      throw std::invalid_argument("negative increment");
+
+    _count += by;
+  }
+
+private:
+  int _count = 0;
+};
+
+class NamedCounter : public Counter
+{
+public:
+  NamedCounter() noexcept = default;
+
+  char const *name() const noexcept
+  { return "named"; }
+};
+
+} // namespace test
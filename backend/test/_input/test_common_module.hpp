@@ -0,0 +1,26 @@
+namespace test
+{
+
+typedef int common_int;
+
+class CommonPoint
+{
+public:
+  CommonPoint(common_int x, common_int y) noexcept
+  : _x(x), _y(y)
+  {}
+
+  common_int x() const noexcept
+  { return _x; }
+
+  common_int y() const noexcept
+  { return _y; }
+
+private:
+  common_int _x, _y;
+};
+
+inline common_int common_twice(common_int a) noexcept
+{ return 2 * a; }
+
+} // namespace test
@@ -0,0 +1,12 @@
+#include "test_common_module.hpp"
+
+namespace test
+{
+
+inline common_int common_sum(CommonPoint const &p) noexcept
+{ return p.x() + p.y(); }
+
+inline CommonPoint common_shifted(CommonPoint const &p, common_int d) noexcept
+{ return CommonPoint(p.x() + d, p.y() + d); }
+
+} // namespace test
@@ -0,0 +1,27 @@
+namespace test
+{
+
+inline int hashed_min(int a, int b) noexcept
+{ return a < b ? a : b; }
+
+inline int hashed_max(int a, int b) noexcept
+{ return a < b ? b : a; }
+
+class HashedBox
+{
+public:
+  explicit HashedBox(int value) noexcept
+  : _value(value)
+  {}
+
+  int value() const noexcept
+  { return _value; }
+
+  void set_value(int value) noexcept
+  { _value = value; }
+
+private:
+  int _value;
+};
+
+} // namespace test
@@ -0,0 +1,48 @@
+namespace test
+{
+
+class Dependency
+{
+public:
+  Dependency(int value) noexcept
+  : _value(value)
+  {}
+
+  int value() const noexcept
+  { return _value; }
+
+private:
+  int _value;
+};
+
+class RootBase
+{
+public:
+  RootBase() noexcept = default;
+
+  int base_value() const noexcept
+  { return 1; }
+};
+
+class Root : public RootBase
+{
+public:
+  Root() noexcept = default;
+
+  Dependency dependency() const noexcept
+  { return Dependency(2); }
+};
+
+class Unreachable
+{
+public:
+  Unreachable() noexcept = default;
+
+  int value() const noexcept
+  { return 3; }
+};
+
+inline int unreachable_function() noexcept
+{ return 4; }
+
+} // namespace test
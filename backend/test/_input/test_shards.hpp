@@ -0,0 +1,48 @@
+namespace test
+{
+
+inline int shard_add(int a, int b) noexcept
+{ return a + b; }
+
+inline int shard_sub(int a, int b) noexcept
+{ return a - b; }
+
+inline int shard_mul(int a, int b) noexcept
+{ return a * b; }
+
+inline int shard_div(int a, int b) noexcept
+{ return a / b; }
+
+class ShardPoint
+{
+public:
+  ShardPoint(int x, int y) noexcept
+  : _x(x), _y(y)
+  {}
+
+  int x() const noexcept
+  { return _x; }
+
+  int y() const noexcept
+  { return _y; }
+
+private:
+  int _x, _y;
+};
+
+class ShardCounter
+{
+public:
+  ShardCounter() noexcept = default;
+
+  void increment() noexcept
+  { ++_count; }
+
+  int count() const noexcept
+  { return _count; }
+
+private:
+  int _count = 0;
+};
+
+} // namespace test
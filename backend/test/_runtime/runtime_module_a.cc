@@ -0,0 +1,25 @@
+// Module defining a type instance for 'RuntimeBase' only.
+
+#include "runtime_types.h"
+
+namespace cppbind::type_info
+{
+
+extern type_instance<RuntimeBase> const _runtime_base;
+template<> inline constexpr type const *instance_of<RuntimeBase> = &_runtime_base;
+
+type_instance<RuntimeBase> const _runtime_base;
+
+namespace
+{
+  type const *const _types[] = {
+    &_runtime_base
+  };
+
+  type_table const _type_table(_types);
+}
+
+} // namespace cppbind::type_info
+
+cppbind::type_info::type const *runtime_module_a_base_type()
+{ return cppbind::type_info::type::get<RuntimeBase>(); }
@@ -0,0 +1,34 @@
+// Module defining a type instance for 'RuntimeDerived' only, 'RuntimeBase'
+// has to be looked up in the registry.
+
+#include "runtime_types.h"
+
+namespace cppbind::type_info
+{
+
+extern type_instance<RuntimeDerived, base<RuntimeBase, 0>> const _runtime_derived;
+template<> inline constexpr type const *instance_of<RuntimeDerived> = &_runtime_derived;
+
+type_instance<RuntimeDerived, base<RuntimeBase, 0>> const _runtime_derived;
+
+namespace
+{
+  type const *const _types[] = {
+    &_runtime_derived
+  };
+
+  type_table const _type_table(_types);
+}
+
+} // namespace cppbind::type_info
+
+extern "C"
+{
+
+cppbind::type_info::type const *runtime_module_b_base_type()
+{ return cppbind::type_info::type::get<RuntimeBase>(); }
+
+void *runtime_module_b_new_derived()
+{ return cppbind::type_info::make_typed(new RuntimeDerived, nullptr, true); }
+
+} // extern "C"
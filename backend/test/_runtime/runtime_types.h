@@ -0,0 +1,30 @@
+#ifndef GUARD_RUNTIME_TYPES_H
+#define GUARD_RUNTIME_TYPES_H
+
+#include "cppbind/type_info.h"
+
+struct RuntimeBase
+{
+  virtual ~RuntimeBase() = default;
+
+  int base = 1;
+};
+
+struct RuntimeDerived : public RuntimeBase
+{
+  int derived = 2;
+};
+
+// Defined by runtime_module_a.cc, which is linked into the test.
+cppbind::type_info::type const *runtime_module_a_base_type();
+
+// Defined by runtime_module_b.cc, which the test loads at runtime.
+extern "C"
+{
+
+typedef cppbind::type_info::type const *(*runtime_module_b_base_type_t)();
+typedef void *(*runtime_module_b_new_derived_t)();
+
+}
+
+#endif // GUARD_RUNTIME_TYPES_H
@@ -0,0 +1,93 @@
+// Tests the type registry shared between modules linked against
+// 'cppbind_runtime', the path of runtime_module_b is passed as an argument.
+
+#include <assert.h>
+#include <dlfcn.h>
+
+#include <random>
+#include <unordered_map>
+
+#include "runtime_types.h"
+
+using namespace cppbind::type_info;
+
+static void test_type_map()
+{
+  type_map<int> map;
+  std::unordered_map<type_id::id_t, int> expected;
+
+  // Few distinct keys so that inserts and erases collide frequently.
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<type_id::id_t> key(0, 255);
+
+  for (int i = 0; i < 100000; ++i) {
+    auto k = key(rng) * 0x10000;
+
+    if (rng() % 3 == 0) {
+      assert(map.erase(k) == (expected.erase(k) == 1));
+    } else {
+      map.insert(k, i);
+      expected[k] = i;
+    }
+
+    assert(map.size() == expected.size());
+  }
+
+  for (type_id::id_t k = 0; k < 256; ++k) {
+    auto it = map.find(k * 0x10000);
+    auto it_expected = expected.find(k * 0x10000);
+
+    if (it_expected == expected.end()) {
+      assert(it == map.end());
+    } else {
+      assert(it != map.end());
+      assert(it->second == it_expected->second);
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  assert(argc == 2);
+
+  test_type_map();
+
+  // Found from a module not defining the type.
+  assert(type::get<RuntimeBase>() == runtime_module_a_base_type());
+
+  assert(!get_registry().find(type_id::id<RuntimeDerived>()));
+
+  void *module_b = dlopen(argv[1], RTLD_NOW | RTLD_LOCAL);
+  assert(module_b);
+
+  {
+    auto base_type = reinterpret_cast<runtime_module_b_base_type_t>(
+      dlsym(module_b, "runtime_module_b_base_type"));
+
+    auto new_derived = reinterpret_cast<runtime_module_b_new_derived_t>(
+      dlsym(module_b, "runtime_module_b_new_derived"));
+
+    assert(base_type && new_derived);
+
+    // Found from the other module.
+    assert(base_type() == runtime_module_a_base_type());
+
+    assert(get_registry().find(type_id::id<RuntimeDerived>()));
+
+    // Objects created by one module can be cast by another.
+    void *derived = new_derived();
+
+    assert(typed_pointer_cast<RuntimeBase>(derived)->base == 1);
+    assert(typed_pointer_cast<RuntimeDerived>(derived)->derived == 2);
+
+    bind_delete(derived);
+  }
+
+  dlclose(module_b);
+
+  // Unregistered when unloaded.
+  assert(!get_registry().find(type_id::id<RuntimeDerived>()));
+  assert(get_registry().find(type_id::id<RuntimeBase>()));
+
+  return 0;
+}
@@ -0,0 +1,16 @@
+#include <assert.h>
+
+#include "test_backend_from_source_c.h"
+
+int main()
+{
+  assert(test_answer() == 42);
+
+  {
+    struct test_oracle oracle = test_oracle_new();
+    assert(test_oracle_get(&oracle) == 42);
+    test_oracle_delete(&oracle);
+  }
+
+  return 0;
+}
@@ -0,0 +1,46 @@
+#include <assert.h>
+#include <string.h>
+
+#include "test_call_thunks_c.h"
+
+int main()
+{
+  assert(test_add(1, 2) == 3);
+  assert(test_scale(1.5, 2.0f) == 3.0);
+  assert(test_negate(0) == 1);
+  assert(strcmp(test_greet(), "hello") == 0);
+
+  bind_error_reset();
+  assert(test_check_positive(1) == 1);
+  assert(!bind_error_what());
+
+  bind_error_reset();
+  test_check_positive(0);
+  assert(bind_error_what() && strcmp(bind_error_what(), "not positive") == 0);
+
+  {
+    struct test_counter counter = test_counter_new();
+
+    test_counter_increment(&counter, 2);
+    assert(test_counter_count(&counter) == 2);
+
+    bind_error_reset();
+    test_counter_increment(&counter, -1);
+    assert(bind_error_what() && strcmp(bind_error_what(), "negative increment") == 0);
+    assert(test_counter_count(&counter) == 2);
+
+    test_counter_delete(&counter);
+  }
+
+  {
+    struct test_named_counter named_counter = test_named_counter_new();
+
+    test_named_counter_increment(&named_counter, 3);
+    assert(test_named_counter_count(&named_counter) == 3);
+    assert(strcmp(test_named_counter_name(&named_counter), "named") == 0);
+
+    test_named_counter_delete(&named_counter);
+  }
+
+  return 0;
+}
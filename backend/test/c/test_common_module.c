@@ -0,0 +1,26 @@
+#include <assert.h>
+
+#include "test_common_module_c.h"
+#include "test_common_module_other_c.h"
+
+int main()
+{
+  {
+    test_common_int_t a = test_common_twice(1);
+    assert(a == 2);
+  }
+
+  {
+    struct test_common_point point = test_common_point_new(1, 2);
+    assert(test_common_sum(&point) == 3);
+
+    struct test_common_point shifted = test_common_shifted(&point, 1);
+    assert(test_common_point_x(&shifted) == 2);
+    assert(test_common_point_y(&shifted) == 3);
+
+    test_common_point_delete(&point);
+    test_common_point_delete(&shifted);
+  }
+
+  return 0;
+}
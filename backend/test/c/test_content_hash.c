@@ -0,0 +1,20 @@
+#include <assert.h>
+
+#include "test_content_hash_c.h"
+
+int main()
+{
+  assert(test_hashed_min(1, 2) == 1);
+  assert(test_hashed_max(1, 2) == 2);
+
+  {
+    struct test_hashed_box box = test_hashed_box_new(1);
+
+    test_hashed_box_set_value(&box, 2);
+    assert(test_hashed_box_value(&box) == 2);
+
+    test_hashed_box_delete(&box);
+  }
+
+  return 0;
+}
@@ -0,0 +1,30 @@
+#include <assert.h>
+
+#include "test_prune_roots_c.h"
+
+void test_unreachable_new() {}
+void test_unreachable_value() {}
+void test_unreachable_function() {}
+
+int main()
+{
+  {
+    struct test_root root = test_root_new();
+
+    assert(test_root_base_value(&root) == 1);
+
+    struct test_dependency dependency = test_root_dependency(&root);
+    assert(test_dependency_value(&dependency) == 2);
+
+    test_dependency_delete(&dependency);
+    test_root_delete(&root);
+  }
+
+  {
+    struct test_root_base root_base = test_root_base_new();
+    assert(test_root_base_base_value(&root_base) == 1);
+    test_root_base_delete(&root_base);
+  }
+
+  return 0;
+}
@@ -0,0 +1,31 @@
+#include <assert.h>
+
+#include "test_shards_c.h"
+
+int main()
+{
+  assert(test_shard_add(6, 2) == 8);
+  assert(test_shard_sub(6, 2) == 4);
+  assert(test_shard_mul(6, 2) == 12);
+  assert(test_shard_div(6, 2) == 3);
+
+  {
+    struct test_shard_point point = test_shard_point_new(1, 2);
+
+    assert(test_shard_point_x(&point) == 1);
+    assert(test_shard_point_y(&point) == 2);
+
+    test_shard_point_delete(&point);
+  }
+
+  {
+    struct test_shard_counter counter = test_shard_counter_new();
+
+    test_shard_counter_increment(&counter);
+    assert(test_shard_counter_count(&counter) == 1);
+
+    test_shard_counter_delete(&counter);
+  }
+
+  return 0;
+}
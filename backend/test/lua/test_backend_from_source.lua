@@ -0,0 +1,8 @@
+require 'test_backend_from_source'
+
+assert(test.answer() == 42)
+
+do
+  local oracle = test.Oracle.new()
+  assert(oracle:get() == 42)
+end
@@ -0,0 +1,36 @@
+require 'test_call_thunks'
+
+assert(test.add(1, 2) == 3)
+assert(test.scale(1.5, 2.0) == 3.0)
+assert(test.negate(false) == true)
+assert(test.greet() == "hello")
+
+res, e = pcall(test.add, 1)
+assert(not res)
+assert(e == 'function expects 2 arguments')
+
+assert(test.check_positive(1) == 1)
+
+res, e = pcall(test.check_positive, 0)
+assert(not res)
+assert(e == 'not positive')
+
+do
+  local counter = test.Counter.new()
+
+  counter:increment(2)
+  assert(counter:count() == 2)
+
+  res, e = pcall(counter.increment, counter, -1)
+  assert(not res)
+  assert(e == 'negative increment')
+  assert(counter:count() == 2)
+end
+
+do
+  local named_counter = test.NamedCounter.new()
+
+  named_counter:increment(3)
+  assert(named_counter:count() == 3)
+  assert(named_counter:name() == "named")
+end
@@ -0,0 +1,13 @@
+require 'test_common_module'
+require 'test_common_module_other'
+
+assert(test.common_twice(1) == 2)
+
+do
+  local point = test.CommonPoint.new(1, 2)
+  assert(test.common_sum(point) == 3)
+
+  local shifted = test.common_shifted(point, 1)
+  assert(shifted:x() == 2)
+  assert(shifted:y() == 3)
+end
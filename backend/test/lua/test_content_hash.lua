@@ -0,0 +1,11 @@
+require 'test_content_hash'
+
+assert(test.hashed_min(1, 2) == 1)
+assert(test.hashed_max(1, 2) == 2)
+
+do
+  local box = test.HashedBox.new(1)
+
+  box:set_value(2)
+  assert(box:value() == 2)
+end
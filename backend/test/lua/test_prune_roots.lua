@@ -0,0 +1,16 @@
+require 'test_prune_roots'
+
+assert(test.Unreachable == nil)
+assert(test.unreachable_function == nil)
+
+do
+  local root = test.Root.new()
+
+  assert(root:base_value() == 1)
+  assert(root:dependency():value() == 2)
+end
+
+do
+  local root_base = test.RootBase.new()
+  assert(root_base:base_value() == 1)
+end
@@ -0,0 +1,20 @@
+require 'test_shards'
+
+assert(test.shard_add(6, 2) == 8)
+assert(test.shard_sub(6, 2) == 4)
+assert(test.shard_mul(6, 2) == 12)
+assert(test.shard_div(6, 2) == 3)
+
+do
+  local point = test.ShardPoint.new(1, 2)
+
+  assert(point:x() == 1)
+  assert(point:y() == 2)
+end
+
+do
+  local counter = test.ShardCounter.new()
+
+  counter:increment()
+  assert(counter:count() == 1)
+end
@@ -0,0 +1,26 @@
+use std::ffi::*;
+
+mod test_common_module_shared_rust;
+
+include!("test_common_module_rust.rs");
+include!("test_common_module_other_rust.rs");
+
+fn main() {
+    unsafe {
+
+    {
+        let a: TestCommonInt = test_common_twice(1);
+        assert_eq!(a, 2);
+    }
+
+    {
+        let point = TestCommonPoint::new(1, 2);
+        assert_eq!(test_common_sum(&point), 3);
+
+        let shifted = test_common_shifted(&point, 1);
+        assert_eq!(shifted.x(), 2);
+        assert_eq!(shifted.y(), 3);
+    }
+
+    }
+}
@@ -2,6 +2,12 @@
 #define GUARD_CPPBIND_C_UTIL_CC_H
 
 #include <cstring>
+#include <exception>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "cppbind/c/c_bind_error_cc.h"
 
 namespace cppbind
 {
@@ -72,6 +78,28 @@ typename std::enable_if<!std::is_const<T>::value, T *>::type
 non_owning_struct_cast(S const *s)
 { return const_cast<T *>(non_owning_struct_cast<T const>(s)); }
 
+// Call thunk for wrapper functions whose parameters and return values need no
+// translation beyond implicit conversions. 'F' is a (member) function pointer,
+// exceptions are propagated via 'bind_error' just like in fully expanded
+// wrapper functions.
+template<auto F, typename ...ARGS>
+std::invoke_result_t<decltype(F), ARGS...>
+invoke(ARGS ...args)
+{
+  using R = std::invoke_result_t<decltype(F), ARGS...>;
+
+  try {
+    return std::invoke(F, args...);
+  } catch (std::exception const &e) {
+    bind_error = e.what();
+  } catch (...) {
+    bind_error = "exception";
+  }
+
+  if constexpr (!std::is_void_v<R>)
+    return R{};
+}
+
 } // namespace c
 
 } // namespace cppbind
@@ -2,8 +2,12 @@
 #define GUARD_CPPBIND_LUA_UTIL_H
 
 #include <cassert>
+#include <exception>
+#include <functional>
 #include <initializer_list>
 #include <limits>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 
 extern "C" {
@@ -180,6 +184,174 @@ void pushfloating(lua_State *L, T val)
   lua_pushnumber(L, val);
 }
 
+// Argument and return value converters used by 'invoke' below, only types with
+// a straightforward Lua representation are supported.
+template<typename T, typename = void>
+struct convert;
+
+template<typename T>
+struct convert<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>>
+{
+  static T to(lua_State *L, int arg)
+  {
+    luaL_checktype(L, arg, LUA_TNUMBER);
+    return tointegral<T>(L, arg);
+  }
+
+  static void push(lua_State *L, T val)
+  { pushintegral(L, val); }
+};
+
+template<typename T>
+struct convert<T, std::enable_if_t<std::is_floating_point_v<T>>>
+{
+  static T to(lua_State *L, int arg)
+  {
+    luaL_checktype(L, arg, LUA_TNUMBER);
+    return tofloating<T>(L, arg);
+  }
+
+  static void push(lua_State *L, T val)
+  { pushfloating(L, val); }
+};
+
+template<>
+struct convert<bool>
+{
+  static bool to(lua_State *L, int arg)
+  {
+    luaL_checktype(L, arg, LUA_TBOOLEAN);
+    return lua_toboolean(L, arg);
+  }
+
+  static void push(lua_State *L, bool val)
+  { lua_pushboolean(L, val); }
+};
+
+template<>
+struct convert<char const *>
+{
+  static char const *to(lua_State *L, int arg)
+  {
+    luaL_checktype(L, arg, LUA_TSTRING);
+    return lua_tostring(L, arg);
+  }
+
+  static void push(lua_State *L, char const *val)
+  { lua_pushstring(L, val); }
+};
+
+template<typename F>
+struct function_traits;
+
+template<typename R, typename ...ARGS>
+struct function_traits<R(*)(ARGS...)>
+{
+  using self_type = void;
+  using return_type = R;
+  using argument_types = std::tuple<std::decay_t<ARGS>...>;
+};
+
+template<typename R, typename C, typename ...ARGS>
+struct function_traits<R(C::*)(ARGS...)>
+{
+  using self_type = C;
+  using return_type = R;
+  using argument_types = std::tuple<std::decay_t<ARGS>...>;
+};
+
+template<typename R, typename C, typename ...ARGS>
+struct function_traits<R(C::*)(ARGS...) const>
+{
+  using self_type = C const;
+  using return_type = R;
+  using argument_types = std::tuple<std::decay_t<ARGS>...>;
+};
+
+template<auto F, typename SELF, typename R, typename ARGS, std::size_t ...IS>
+int _invoke(lua_State *L, std::index_sequence<IS...>)
+{
+  constexpr int num_self = std::is_void_v<SELF> ? 0 : 1;
+  constexpr int num_args = num_self + static_cast<int>(sizeof...(IS));
+
+  if (lua_gettop(L) != num_args)
+    return luaL_error(L, "function expects %d arguments", num_args);
+
+  void *self_userdata = nullptr;
+
+  if constexpr (num_self > 0) {
+    luaL_checktype(L, 1, LUA_TUSERDATA);
+    self_userdata = lua_touserdata(L, 1);
+  }
+
+  ARGS args { convert<std::tuple_element_t<IS, ARGS>>::to(L, num_self + IS + 1)... };
+  static_cast<void>(args);
+
+  std::conditional_t<std::is_void_v<R>, int, std::decay_t<R>> ret {};
+
+  // Lua errors must not be raised from within the handlers below since Lua
+  // might have been compiled as C, in which case 'lua_error' longjmps.
+  bool success = false;
+
+  try {
+    if constexpr (num_self > 0) {
+      auto self = type_info::typed_pointer_cast<SELF>(self_userdata);
+
+      if constexpr (std::is_void_v<R>)
+        std::invoke(F, self, std::get<IS>(args)...);
+      else
+        ret = std::invoke(F, self, std::get<IS>(args)...);
+    } else {
+      static_cast<void>(self_userdata);
+
+      if constexpr (std::is_void_v<R>)
+        std::invoke(F, std::get<IS>(args)...);
+      else
+        ret = std::invoke(F, std::get<IS>(args)...);
+    }
+
+    success = true;
+
+  } catch (std::exception const &e) {
+    lua_pushstring(L, e.what());
+  } catch (...) {
+    lua_pushstring(L, "exception");
+  }
+
+  if (!success)
+    return lua_error(L);
+
+  if constexpr (std::is_void_v<R>) {
+    static_cast<void>(ret);
+    return 0;
+  } else {
+    convert<std::decay_t<R>>::push(L, ret);
+    return 1;
+  }
+}
+
+// Call thunk for wrapper functions whose parameters and return values are all
+// supported by 'convert' above. 'F' is a function pointer or a pointer to a
+// (possibly const) member function, in the latter case the object the member
+// function is invoked on is expected as the first argument.
+// 'SELF' is the class on which member function 'F' is called, only needed if
+// it differs from the class 'F' is a member of, i.e. if 'F' is inherited.
+template<auto F, typename SELF = void>
+int invoke(lua_State *L)
+{
+  using traits = function_traits<decltype(F)>;
+
+  using self = std::conditional_t<
+    std::is_void_v<SELF>,
+    typename traits::self_type,
+    std::conditional_t<std::is_const_v<typename traits::self_type>, SELF const, SELF>>;
+
+  using args = typename traits::argument_types;
+
+  return _invoke<F, self, typename traits::return_type, args>(
+    L, std::make_index_sequence<std::tuple_size_v<args>>());
+}
+
 } // namespace lua
 
 } // namespace cppbind
@@ -0,0 +1,32 @@
+// Process wide type registry, built into the 'cppbind_runtime' shared library.
+// Modules compiled with 'TYPE_INFO_SHARED_REGISTRY' and linked against it
+// register their type tables here when loaded and unregister them when
+// unloaded, see 'registry' in type_info.h for how lookups work.
+
+#ifndef TYPE_INFO_SHARED_REGISTRY
+#define TYPE_INFO_SHARED_REGISTRY
+#endif
+
+#include "type_info.h"
+
+namespace cppbind
+{
+
+namespace type_info
+{
+
+namespace
+{
+
+// Constant-initialized, modules may register their types before the dynamic
+// initialization of this library has run.
+registry shared_registry;
+
+} // namespace
+
+registry &get_registry()
+{ return shared_registry; }
+
+} // namespace type_info
+
+} // namespace cppbind
@@ -1,13 +1,18 @@
 #ifndef GUARD_CPPBIND_TYPE_INFO_H
 #define GUARD_CPPBIND_TYPE_INFO_H
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <memory>
 #include <type_traits>
 #include <typeindex>
 #include <utility>
+#include <vector>
 
 #ifndef TYPE_INFO_NO_TYPEID
 #include <typeinfo>
@@ -28,7 +33,9 @@ public:
   static id_t id()
   {
 #ifdef TYPE_INFO_NO_TYPEID
-    return id_no_cv<typename std::remove_cv<T>::type>();
+    using T_no_cv = typename std::remove_cv<T>::type;
+
+    return std::integral_constant<id_t, id_no_cv<T_no_cv>()>::value;
 #else
     return typeid(T).hash_code();
 #endif
@@ -36,16 +43,22 @@ public:
 
 private:
 #ifdef TYPE_INFO_NO_TYPEID
+  // Type identifiers are hashes of the type names contained in
+  // '__PRETTY_FUNCTION__', computed at compile time.
   template<typename T>
-  static id_t id_no_cv()
+  static constexpr id_t id_no_cv()
   {
-    std::size_t len;
-    char const *str = str_type<T>(&len);
+    char const *str_ref = str_pretty_function<int>();
+    std::size_t len_prefix_ref = str_find(str_ref, "int");
+    std::size_t len_postfix_ref = str_len(str_ref) - len_prefix_ref - str_len("int");
+
+    char const *str = str_pretty_function<T>() + len_prefix_ref;
+    std::size_t len = str_len(str) - len_postfix_ref;
 
     return str_hash_fnv1a(str, len);
   }
 
-  static uint64_t str_hash_fnv1a(char const *str, std::size_t len)
+  static constexpr uint64_t str_hash_fnv1a(char const *str, std::size_t len)
   {
     uint64_t h = 0xcbf29ce484222325;
 
@@ -57,50 +70,65 @@ private:
     return h;
   }
 
-  template<typename T>
-  static char const *str_type(std::size_t *len)
+  static constexpr std::size_t str_len(char const *str)
   {
-    static char const *str_ref = str_pretty_function<int>();
-    static std::size_t len_ref = std::strlen(str_ref);
-    static std::size_t len_prefix_ref = std::strstr(str_ref, "int") - str_ref;
-    static std::size_t len_postfix_ref = len_ref - len_prefix_ref - std::strlen("int");
+    std::size_t len = 0;
 
-    char const *str = str_pretty_function<T>() + len_prefix_ref;
-    *len = std::strlen(str) - len_postfix_ref;
+    while (str[len])
+      ++len;
 
-    return str;
+    return len;
+  }
+
+  static constexpr std::size_t str_find(char const *str, char const *sub)
+  {
+    for (std::size_t i = 0; str[i]; ++i) {
+      std::size_t j = 0;
+
+      while (sub[j] && str[i + j] == sub[j])
+        ++j;
+
+      if (!sub[j])
+        return i;
+    }
+
+    return str_len(str);
   }
 
   template<typename T>
-  static char const *str_pretty_function()
+  static constexpr char const *str_pretty_function()
   { return __PRETTY_FUNCTION__; }
 #endif
 };
 
+// Hash table mapping type identifiers to values. Uses open addressing with
+// linear probing over a single contiguous array whose capacity is always a
+// power of two and which is doubled whenever it becomes half full, so inserting
+// only allocates when the table grows. Iterators are invalidated by 'insert'.
 template<typename T>
 class type_map
 {
+  using value_type = std::pair<type_id::id_t, T>;
+
+  struct slot
+  {
+    value_type data;
+    bool used = false;
+  };
+
 public:
   class const_iterator
   {
   public:
-    using pointer = std::pair<type_id::id_t, T> const *;
-    using reference = std::pair<type_id::id_t, T> const &;
+    using pointer = value_type const *;
+    using reference = value_type const &;
 
     const_iterator(pointer data = nullptr)
     : _data(data)
     {}
 
     bool operator==(const_iterator const &rhs) const
-    {
-      if (!_data && !rhs._data)
-        return true;
-
-      if (!!_data != !!rhs._data)
-        return false;
-
-      return *_data == *rhs._data;
-    }
+    { return _data == rhs._data; }
 
     bool operator!=(const_iterator const &rhs) const
     { return !operator==(rhs); }
@@ -115,91 +143,307 @@ public:
     pointer _data;
   };
 
-  type_map()
+  // Inserting a key that is already present replaces its value.
+  std::pair<const_iterator, bool> insert(type_id::id_t key, T const &val)
+  {
+    if (2 * (_size + 1) > _capacity)
+      rehash(_capacity ? 2 * _capacity : INITIAL_CAPACITY);
+
+    auto &s = _slots[probe(key)];
+
+    bool inserted = !s.used;
+
+    if (inserted) {
+      s.data.first = key;
+      s.used = true;
+      ++_size;
+    }
+
+    s.data.second = val;
+
+    return std::make_pair(const_iterator(&s.data), inserted);
+  }
+
+  const_iterator find(type_id::id_t key) const
   {
-    for (type_id::id_t i = 0; i < HASH_TABLE_SZ; ++i)
-      _hash_table[i] = nullptr;
+    if (!_capacity)
+      return end();
+
+    auto &s = _slots[probe(key)];
+
+    return s.used ? const_iterator(&s.data) : end();
   }
 
-  ~type_map()
+  const_iterator end() const
+  { return const_iterator(); }
+
+  // Entries following the erased one in the same probe sequence are shifted
+  // back so that no tombstones are needed.
+  bool erase(type_id::id_t key)
   {
-    for (type_id::id_t i = 0; i < HASH_TABLE_SZ; ++i) {
-      auto head = _hash_table[i];
-      while (head) {
-        auto next = head->next;
-        delete head;
-        head = next;
+    if (!_capacity)
+      return false;
+
+    auto i = probe(key);
+    if (!_slots[i].used)
+      return false;
+
+    for (auto j = (i + 1) & (_capacity - 1);
+         _slots[j].used;
+         j = (j + 1) & (_capacity - 1)) {
+      auto k = index(_slots[j].data.first);
+
+      // The entry at 'j' can be moved to 'i' unless its home slot 'k' lies
+      // cyclically within '(i, j]'.
+      bool stays = i <= j ? (i < k && k <= j) : (i < k || k <= j);
+      if (!stays) {
+        _slots[i].data = std::move(_slots[j].data);
+        i = j;
       }
     }
+
+    _slots[i].used = false;
+    --_size;
+
+    return true;
   }
 
-  std::pair<const_iterator, bool> insert(type_id::id_t key, T const &val)
+  // Make room for 'n' keys in total so that they can be inserted without
+  // growing the table.
+  void reserve(std::size_t n)
   {
-    auto key_hashed = hash(key);
+    std::size_t capacity = INITIAL_CAPACITY;
+    while (capacity < 2 * n)
+      capacity *= 2;
+
+    if (capacity > _capacity)
+      rehash(capacity);
+  }
+
+  std::size_t size() const
+  { return _size; }
 
-    auto head = _hash_table[key_hashed];
+private:
+  enum : std::size_t { INITIAL_CAPACITY = 16 };
 
-    _hash_table[key_hashed] = new hash_node(key, val, head);
+  // Type identifiers are hashes already but not necessarily well distributed
+  // in their lower bits, hence the multiplicative mixing step.
+  std::size_t index(type_id::id_t key) const
+  {
+    auto mixed = (key * 0x9e3779b97f4a7c15ull) >> 32;
 
-    return std::make_pair(const_iterator(&_hash_table[key_hashed]->data), !head);
+    return static_cast<std::size_t>(mixed) & (_capacity - 1);
   }
 
-  const_iterator find(type_id::id_t key) const
+  // Return the index of the slot containing 'key' or of the free slot where
+  // it belongs.
+  std::size_t probe(type_id::id_t key) const
   {
-    auto key_hashed = hash(key);
+    auto i = index(key);
 
-    auto head = _hash_table[key_hashed];
+    while (_slots[i].used && _slots[i].data.first != key)
+      i = (i + 1) & (_capacity - 1);
 
-    while (head) {
-      if (head->data.first == key)
-        return const_iterator(&head->data);
+    return i;
+  }
 
-      head = head->next;
+  void rehash(std::size_t capacity)
+  {
+    auto slots = std::move(_slots);
+    auto capacity_old = _capacity;
+
+    _slots.reset(new slot[capacity]);
+    _capacity = capacity;
+
+    for (std::size_t i = 0; i < capacity_old; ++i) {
+      if (slots[i].used) {
+        auto &s = _slots[probe(slots[i].data.first)];
+        s.data = std::move(slots[i].data);
+        s.used = true;
+      }
     }
+  }
 
-    return end();
+  std::unique_ptr<slot[]> _slots;
+  std::size_t _capacity = 0;
+  std::size_t _size = 0;
+};
+
+class type;
+
+// Type instance describing 'T', if known at compile time. Specialized by the
+// generated code for all types it uses, other types are looked up in the type
+// registry.
+template<typename T>
+inline constexpr type const *instance_of = nullptr;
+
+class type_table;
+
+// Registry of all types defined by loaded modules, consisting of the tables
+// registered by the modules (see 'type_table'). Types are only inserted into
+// the registry's lookup table by the first lookup missing it after a module
+// has been loaded or unloaded. Lookup tables are immutable once published and
+// lookups don't lock. Modules are added and removed by replacing the list of
+// tables, so that's lock free as well. Replaced lists and lookup tables are
+// kept until the registry itself is destroyed since concurrent lookups might
+// still be reading them, this is bounded by the number of times modules are
+// loaded and unloaded.
+class registry
+{
+  struct tables
+  {
+    std::vector<type_table const *> entries;
+    tables const *prev;
+  };
+
+  struct snapshot
+  {
+    type_map<type const *> types;
+    tables const *from;
+    snapshot const *prev;
+  };
+
+public:
+  constexpr registry() = default;
+
+  registry(registry const &) = delete;
+  registry &operator=(registry const &) = delete;
+
+  ~registry()
+  {
+    for (auto const *t = _tables.load(); t;) {
+      auto const *prev = t->prev;
+      delete t;
+      t = prev;
+    }
+
+    for (auto const *s = _snapshot.load(); s;) {
+      auto const *prev = s->prev;
+      delete s;
+      s = prev;
+    }
   }
 
-  const_iterator end() const
-  { return const_iterator(); }
+  void add(type_table const *table)
+  {
+    update([table](std::vector<type_table const *> &entries)
+           { entries.push_back(table); });
+  }
 
-private:
-  enum : type_id::id_t { HASH_TABLE_SZ = 149 };
+  void remove(type_table const *table)
+  {
+    update([table](std::vector<type_table const *> &entries)
+           {
+             entries.erase(std::remove(entries.begin(), entries.end(), table),
+                           entries.end());
+           });
+
+    // The current lookup table might contain types of the removed table,
+    // replace it with an empty one which is rebuilt by the next lookup.
+    auto const *current = _snapshot.load(std::memory_order_acquire);
+
+    auto *empty = new snapshot{{}, nullptr, current};
+
+    while (!_snapshot.compare_exchange_weak(empty->prev, empty,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_acquire))
+      ;
+  }
 
-  struct hash_node
+  // If several tables contain the same type, the one registered most recently
+  // is returned.
+  type const *find(type_id::id_t identifier)
   {
-    hash_node(type_id::id_t key, T const &val, hash_node *next = nullptr)
-    : data(key, val),
-      next(next)
-    {}
+    for (;;) {
+      auto const *current = _snapshot.load(std::memory_order_acquire);
 
-    std::pair<type_id::id_t, T> data;
+      if (current) {
+        auto it = current->types.find(identifier);
+        if (it != current->types.end())
+          return it->second;
+      }
 
-    hash_node *next;
-  };
+      auto const *from = _tables.load(std::memory_order_acquire);
 
-  static type_id::id_t hash(type_id::id_t key)
-  { return key % HASH_TABLE_SZ; }
+      if (from == (current ? current->from : nullptr))
+        return nullptr;
 
-  hash_node * _hash_table[HASH_TABLE_SZ];
+      auto *next = new snapshot{build(from), from, current};
+
+      if (_snapshot.compare_exchange_strong(next->prev, next,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_acquire)) {
+        continue;
+      }
+
+      delete next;
+    }
+  }
+
+private:
+  // Replace the list of tables by a modified copy, retried if another thread
+  // replaced it concurrently.
+  template<typename FUNC>
+  void update(FUNC &&f)
+  {
+    auto *next = new tables{{}, _tables.load(std::memory_order_acquire)};
+
+    do {
+      next->entries = next->prev ? next->prev->entries
+                                 : std::vector<type_table const *>{};
+
+      f(next->entries);
+    } while (!_tables.compare_exchange_weak(next->prev, next,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_acquire));
+  }
+
+  static type_map<type const *> build(tables const *from);
+
+  std::atomic<tables const *> _tables{nullptr};
+  std::atomic<snapshot const *> _snapshot{nullptr};
 };
 
+#ifdef TYPE_INFO_SHARED_REGISTRY
+// Process wide registry shared by all modules defining
+// 'TYPE_INFO_SHARED_REGISTRY', implemented by the 'cppbind_runtime' library
+// (see type_info.cc). Without it, every module has a registry of its own.
+registry &get_registry();
+#else
+inline registry _registry;
+
+inline registry &get_registry()
+{ return _registry; }
+#endif
+
 class type
 {
 public:
-  static void add(type_id::id_t identifier, type const *type)
-  { lookup().insert(identifier, type); }
+  type(type const &) = delete;
+  type &operator=(type const &) = delete;
 
+  // Types used by the calling code are normally resolved at compile time,
+  // only types it does not know about need a registry lookup.
   template<typename T>
   static type const *get()
   {
-    auto it(lookup().find(type_id::id<T>()));
-    assert(it != lookup().end());
+    auto const *instance = instance_of<typename std::remove_cv<T>::type>;
+    if (instance)
+      return instance;
 
-    return it->second;
+    auto const *found = get_registry().find(type_id::id<T>());
+    assert(found);
+
+    return found;
   }
 
-  type_id::id_t identifier() const { return _identifier; }
+  type_id::id_t identifier() const
+  { return _identifier(); }
+
+  // Identifier functions are unique per type within a module and cheaper to
+  // compare than identifiers, which are only unique across modules.
+  bool has_identifier_function(type_id::id_t (*identifier)()) const
+  { return _identifier == identifier; }
 
   virtual void *copy(void const *obj) const = 0;
   virtual void *move(void *obj) const = 0;
@@ -209,28 +453,37 @@ public:
   virtual void *cast(type const *to, void *obj) const = 0;
 
 protected:
-  type(type_id::id_t identifier)
-  : _identifier(std::move(identifier))
-  { add(_identifier, this); }
+  constexpr type(type_id::id_t (*identifier)())
+  : _identifier(identifier)
+  {}
+
+  ~type() = default;
 
 private:
-  static type_map<type const*> &lookup()
-  {
-    static type_map<type const*> _lookup;
+  type_id::id_t (*_identifier)();
+};
 
-    return _lookup;
-  }
+// Base types of a 'type_instance', non-virtual bases are cast to by adding
+// their offset within the derived type (computed by the generator) while
+// casts to virtual bases are left to the compiler. Plain base types are
+// treated like virtual ones.
+template<typename T, std::ptrdiff_t OFFSET>
+struct base {};
 
-  type_id::id_t _identifier;
-};
+template<typename T>
+struct virtual_base {};
 
+// Instances are constant-initialized, so defining them costs nothing when a
+// module is loaded.
 template<typename T, typename ...T_BASES>
-class type_instance : public type
+class type_instance final : public type
 {
 public:
-  type_instance()
-  : type(type_id::id<T>())
-  { add_base_casts(); }
+  constexpr type_instance()
+  : type(&type_id::id<T>),
+    _casts{{ make_base_cast(static_cast<base<T, 0> const *>(nullptr)),
+             make_base_cast(static_cast<T_BASES const *>(nullptr))... }}
+  {}
 
   void *copy(void const *obj) const override
   { return _copy(obj); }
@@ -243,11 +496,19 @@ public:
 
   void const *cast(type const *to, void const *obj) const override
   {
-    auto it(_casts.find(to->identifier()));
-    if (it == _casts.end())
-      throw std::bad_cast();
+    for (auto const &c : _casts) {
+      if (to->has_identifier_function(c.base))
+        return c.apply(obj);
+    }
+
+    auto to_identifier = to->identifier();
+
+    for (auto const &c : _casts) {
+      if (c.base() == to_identifier)
+        return c.apply(obj);
+    }
 
-    return (it->second)(obj);
+    throw std::bad_cast();
   }
 
   void *cast(type const *to, void *obj) const override
@@ -290,8 +551,25 @@ private:
   _destroy(void const *) const
   {}
 
+  // Casts to base classes are stored in a small table which is searched
+  // linearly, 'cast' is only set for virtual bases.
+  struct base_cast
+  {
+    type_id::id_t (*base)();
+    std::ptrdiff_t offset;
+    void const *(*cast)(void const *);
+
+    void const *apply(void const *obj) const
+    {
+      if (cast)
+        return cast(obj);
+
+      return static_cast<char const *>(obj) + offset;
+    }
+  };
+
   template<typename U>
-  static void const *cast(void const *obj)
+  static void const *cast_to(void const *obj)
   {
     auto const *from = static_cast<T const *>(obj);
     auto const *to = static_cast<U const *>(from);
@@ -299,20 +577,72 @@ private:
     return static_cast<void const *>(to);
   }
 
+  template<typename U, std::ptrdiff_t OFFSET>
+  static constexpr base_cast make_base_cast(base<U, OFFSET> const *)
+  { return base_cast{&type_id::id<U>, OFFSET, nullptr}; }
+
   template<typename U>
-  void add_cast()
-  { _casts.insert(type_id::id<U>(), cast<U>); }
+  static constexpr base_cast make_base_cast(virtual_base<U> const *)
+  { return base_cast{&type_id::id<U>, 0, &cast_to<U>}; }
 
-  void add_base_casts()
-  {
-    add_cast<T>();
+  template<typename U>
+  static constexpr base_cast make_base_cast(U const *)
+  { return base_cast{&type_id::id<U>, 0, &cast_to<U>}; }
 
-    [](...){}((add_cast<T_BASES>(), 0)...);
-  }
+  std::array<base_cast, 1 + sizeof...(T_BASES)> _casts;
+};
+
+// Table of the types defined by a module, registered with the type registry
+// while the module is loaded. This is the only part of a module's type
+// information that is not constant-initialized and its cost does not depend
+// on the number of types.
+class type_table
+{
+public:
+  template<std::size_t N>
+  type_table(type const *const (&types)[N])
+  : _types(types),
+    _size(N)
+  { get_registry().add(this); }
+
+  ~type_table()
+  { get_registry().remove(this); }
+
+  type_table(type_table const &) = delete;
+  type_table &operator=(type_table const &) = delete;
+
+  type const *const *begin() const
+  { return _types; }
+
+  type const *const *end() const
+  { return _types + _size; }
 
-  type_map<void const *(*)(void const *)> _casts;
+  std::size_t size() const
+  { return _size; }
+
+private:
+  type const *const *_types;
+  std::size_t _size;
 };
 
+inline type_map<type const *> registry::build(tables const *from)
+{
+  type_map<type const *> types;
+
+  std::size_t size = 0;
+  for (auto const *table : from->entries)
+    size += table->size();
+
+  types.reserve(size);
+
+  for (auto const *table : from->entries) {
+    for (auto const *t : *table)
+      types.insert(t->identifier(), t);
+  }
+
+  return types;
+}
+
 class typed_ptr
 {
 public:
@@ -375,12 +705,7 @@ public:
   template<typename T>
   typename std::enable_if<std::is_const<T>::value, T *>::type
   cast() const
-  {
-    if (_is_const)
-      return static_cast<T *>(_type->cast(type::get<T>(), _obj));
-
-    return static_cast<T *>(_type->cast(type::get<T>(), const_cast<void *>(_obj)));
-  }
+  { return static_cast<T *>(cast_to(type::get<T>())); }
 
   template<typename T>
   typename std::enable_if<!std::is_const<T>::value, T *>::type
@@ -389,10 +714,20 @@ public:
     if (_is_const)
       throw std::bad_cast();
 
-    return static_cast<T *>(_type->cast(type::get<T>(), const_cast<void *>(_obj)));
+    return static_cast<T *>(const_cast<void *>(cast_to(type::get<T>())));
   }
 
 private:
+  // Casting to the object's own type, by far the most common case, needs
+  // neither a virtual call nor a cast table lookup.
+  void const *cast_to(type const *to) const
+  {
+    if (to == _type)
+      return _obj;
+
+    return _type->cast(to, _obj);
+  }
+
   type const *_type;
   void const *_obj;
   bool _is_const;
@@ -0,0 +1,96 @@
+#ifndef GUARD_ARENA_H
+#define GUARD_ARENA_H
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+
+#include "Mixin.hpp"
+
+namespace cppbind
+{
+
+// Simple typed bump allocator. Objects are constructed in place inside fixed
+// size chunks which are never reallocated, so pointers to objects created by
+// an arena remain valid for the arena's whole lifetime. Objects are destroyed
+// all at once when the arena goes out of scope, the only exception being the
+// most recently created object which can be discarded via 'pop'.
+template<typename T, std::size_t CHUNK_SIZE = 256>
+class Arena : private mixin::NotCopyOrMovable
+{
+  using Storage = std::aligned_storage_t<sizeof(T), alignof(T)>;
+
+public:
+  Arena() = default;
+
+  ~Arena()
+  { clear(); }
+
+  template<typename ...ARGS>
+  T *emplace(ARGS &&...Args)
+  {
+    if (Chunks_.empty() || ChunkUsed_ == CHUNK_SIZE) {
+      Chunks_.emplace_back(std::make_unique<Storage[]>(CHUNK_SIZE));
+      ChunkUsed_ = 0;
+    }
+
+    auto *Obj = new (&Chunks_.back()[ChunkUsed_]) T(std::forward<ARGS>(Args)...);
+
+    ++ChunkUsed_;
+
+    Objects_.push_back(Obj);
+
+    return Obj;
+  }
+
+  // Destroy the most recently created object and reuse its memory.
+  void pop()
+  {
+    assert(!Objects_.empty() && ChunkUsed_ > 0);
+
+    Objects_.back()->~T();
+    Objects_.pop_back();
+
+    --ChunkUsed_;
+  }
+
+  T *back() const
+  { return Objects_.back(); }
+
+  std::size_t size() const
+  { return Objects_.size(); }
+
+  bool empty() const
+  { return Objects_.empty(); }
+
+  // Pointers to all live objects in order of creation.
+  llvm::ArrayRef<T *> objects() const
+  { return Objects_; }
+
+  void clear()
+  {
+    for (auto It = Objects_.rbegin(); It != Objects_.rend(); ++It)
+      (*It)->~T();
+
+    Objects_.clear();
+    Chunks_.clear();
+
+    ChunkUsed_ = 0;
+  }
+
+private:
+  std::vector<std::unique_ptr<Storage[]>> Chunks_;
+  std::size_t ChunkUsed_ = 0;
+
+  std::vector<T *> Objects_;
+};
+
+} // namespace cppbind
+
+#endif // GUARD_ARENA_H
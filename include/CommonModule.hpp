@@ -0,0 +1,80 @@
+#ifndef GUARD_COMMON_MODULE_H
+#define GUARD_COMMON_MODULE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Logging.hpp"
+#include "Mixin.hpp"
+
+namespace cppbind {
+
+// This class accumulates the contents of the common modules created by the
+// backends if '--output-common-module' is given. Each common module is
+// identified by its output file and consists of a sequence of sections which
+// are identified by a key so that sections shared between several input files
+// are only added once. Since a new backend instance is created for every input
+// file, this needs to live on the C++ side.
+class CommonModuleRegistry : private mixin::NotCopyOrMovable
+{
+  friend CommonModuleRegistry &CommonModule();
+
+  struct Module
+  {
+    std::unordered_map<std::string, std::size_t> Keys;
+    std::vector<std::string> Sections;
+  };
+
+public:
+  // Returns false if a section with the same key has already been added,
+  // throws if that section differs from 'Section' (e.g. if two input files
+  // define the same typedef differently).
+  bool add(std::string const &File,
+           std::string const &Key,
+           std::string const &Section)
+  {
+    auto &Mod(Modules_[File]);
+
+    auto [It, Added] = Mod.Keys.emplace(Key, Mod.Sections.size());
+
+    if (!Added) {
+      if (Mod.Sections[It->second] != Section)
+        throw log::exception("conflicting definitions of '{0}' in '{1}'",
+                             Key, File);
+
+      return false;
+    }
+
+    Mod.Sections.push_back(Section);
+
+    return true;
+  }
+
+  std::vector<std::string> sections(std::string const &File) const
+  {
+    auto It(Modules_.find(File));
+    if (It == Modules_.end())
+      return {};
+
+    return It->second.Sections;
+  }
+
+private:
+  CommonModuleRegistry() = default;
+
+  static CommonModuleRegistry &instance()
+  {
+    static CommonModuleRegistry CommonModule;
+    return CommonModule;
+  }
+
+  std::unordered_map<std::string, Module> Modules_;
+};
+
+inline CommonModuleRegistry &CommonModule()
+{ return CommonModuleRegistry::instance(); }
+
+} // namespace cppbind
+
+#endif // GUARD_COMMON_MODULE_H
@@ -0,0 +1,33 @@
+#ifndef GUARD_FROZEN_BACKENDS_H
+#define GUARD_FROZEN_BACKENDS_H
+
+#include <cstddef>
+
+#include "llvm/ADT/ArrayRef.h"
+
+namespace cppbind
+{
+
+namespace backend
+{
+
+// Backend module compiled to bytecode at build time, the definitions of the
+// functions below are generated by 'backend/freeze_backends.py'.
+struct FrozenModule
+{
+  char const *Name;
+  unsigned char const *Code; // Marshalled code object.
+  std::size_t Size;
+};
+
+// 'importlib.util.MAGIC_NUMBER' of the Python version used to compile the
+// frozen modules.
+llvm::ArrayRef<unsigned char> frozenModulesMagic();
+
+llvm::ArrayRef<FrozenModule> frozenModules();
+
+} // namespace backend
+
+} // namespace cppbind
+
+#endif // GUARD_FROZEN_BACKENDS_H
@@ -1,14 +1,19 @@
 #ifndef GUARD_WRAPPER_H
 #define GUARD_WRAPPER_H
 
-#include <deque>
 #include <optional>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "llvm/ADT/ArrayRef.h"
+
+#include "Arena.hpp"
 #include "Identifier.hpp"
 #include "Logging.hpp"
+#include "Mixin.hpp"
 #include "Options.hpp"
 #include "WrapperEnum.hpp"
 #include "WrapperFunction.hpp"
@@ -25,16 +30,20 @@ namespace cppbind
 // translation unit for which wrapper code should be generated. It is populated
 // by the callbacks defined in 'CreateWrapperConsumer' and subsequently passed
 // on to the backend.
-class Wrapper
+//
+// All wrapper objects are allocated from per translation unit arenas, i.e.
+// pointers to them remain valid for as long as the 'Wrapper' instance exists
+// and the accessors below hand out non-owning views instead of copies.
+class Wrapper : private mixin::NotCopyOrMovable
 {
 public:
   template<typename ...ARGS>
   void addInclude(ARGS &&...Args)
-  { Includes_.emplace_back(std::forward<ARGS>(Args)...); }
+  { Includes_.emplace(std::forward<ARGS>(Args)...); }
 
   template<typename ...ARGS>
   void addMacro(ARGS &&...Args)
-  { Macros_.emplace_back(std::forward<ARGS>(Args)...); }
+  { Macros_.emplace(std::forward<ARGS>(Args)...); }
 
   template<typename ...ARGS>
   void addWrapperEnum(ARGS &&...Args)
@@ -66,31 +75,40 @@ public:
     addWrapperObject(&Wrapper::_addWrapperRecord,
                      Records_,
                      std::forward<ARGS>(Args)...);
+
+    RecordsOrdered_.reset();
   }
 
   void addOverloads();
 
-  std::vector<WrapperInclude const *> getIncludes() const;
-  std::vector<WrapperMacro const *> getMacros() const;
-  std::vector<WrapperEnum const *> getEnums() const;
-  std::vector<WrapperVariable const *> getVariables() const;
-  std::vector<WrapperFunction const *> getFunctions() const;
-  std::vector<WrapperRecord const *> getRecords() const;
+  // Drop all enums, functions and records which are not transitively
+  // reachable, via function signatures and record bases, from one of the
+  // enums, functions or records whose qualified name matches one of the
+  // regular expressions in 'Roots'. Member functions of reachable records as
+  // well as the types of all variables are always considered reachable.
+  void pruneUnreachable(std::vector<std::string> const &Roots);
+
+  llvm::ArrayRef<WrapperInclude const *> getIncludes() const;
+  llvm::ArrayRef<WrapperMacro const *> getMacros() const;
+  llvm::ArrayRef<WrapperEnum const *> getEnums() const;
+  llvm::ArrayRef<WrapperVariable const *> getVariables() const;
+  llvm::ArrayRef<WrapperFunction const *> getFunctions() const;
+  llvm::ArrayRef<WrapperRecord const *> getRecords() const;
 
 private:
   template<typename T, typename ...ARGS>
   void addWrapperObject(bool(Wrapper::*addObj)(T *),
-                        std::deque<T> &Objs,
+                        Arena<T> &Objs,
                         ARGS &&...Args)
   {
-    Objs.emplace_back(std::forward<ARGS>(Args)...);
+    auto *Obj = Objs.emplace(std::forward<ARGS>(Args)...);
 
-    log::info("creating {0}...", Objs.back());
+    log::info("creating {0}...", *Obj);
 
-    if (!(this->*addObj)(&Objs.back()))
-      Objs.pop_back();
+    if (!(this->*addObj)(Obj))
+      Objs.pop();
     else
-      log::info("created {0}", Objs.back());
+      log::info("created {0}", *Obj);
   }
 
   bool _addWrapperEnum(WrapperEnum *Enum);
@@ -101,16 +119,21 @@ private:
   bool typeWrapped(WrapperType const &Type) const;
   bool checkTypeWrapped(WrapperType const &Type) const;
 
-  std::deque<WrapperInclude> Includes_;
-  std::deque<WrapperMacro> Macros_;
+  Arena<WrapperInclude> Includes_;
+  Arena<WrapperMacro> Macros_;
+
+  Arena<WrapperEnum> Enums_;
+  Arena<WrapperVariable> Variables_;
 
-  std::deque<WrapperEnum> Enums_;
-  std::deque<WrapperVariable> Variables_;
+  Arena<WrapperFunction> Functions_;
+  std::unordered_map<Identifier, std::vector<WrapperFunction const *>> FunctionNames_;
 
-  std::deque<WrapperFunction> Functions_;
-  std::unordered_map<Identifier, std::deque<WrapperFunction const *>> FunctionNames_;
+  Arena<WrapperRecord> Records_;
+  mutable std::optional<std::vector<WrapperRecord const *>> RecordsOrdered_;
 
-  std::deque<WrapperRecord> Records_;
+  std::optional<std::vector<WrapperEnum const *>> EnumsReachable_;
+  std::optional<std::vector<WrapperFunction const *>> FunctionsReachable_;
+  std::optional<std::unordered_set<WrapperRecord const *>> RecordsReachable_;
 };
 
 } // namespace cppbind
@@ -8,6 +8,8 @@
 
 #include "clang/AST/Decl.h"
 
+#include "llvm/ADT/ArrayRef.h"
+
 #include "Identifier.hpp"
 #include "LLVMFormat.hpp"
 #include "LLVMUtil.hpp"
@@ -86,7 +88,7 @@ public:
   WrapperType getType() const
   { return Type_; }
 
-  std::vector<WrapperEnumConstant> const &getConstants() const
+  llvm::ArrayRef<WrapperEnumConstant> getConstants() const
   { return Constants_; }
 
   bool isScoped() const
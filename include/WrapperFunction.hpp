@@ -3,18 +3,19 @@
 
 #include <cassert>
 #include <cstddef>
-#include <deque>
 #include <memory>
 #include <optional>
 #include <sstream>
 #include <string>
 #include <utility>
 #include <variant>
+#include <vector>
 
 #include "clang/AST/Decl.h"
 #include "clang/AST/Expr.h"
 #include "clang/AST/TemplateBase.h"
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include "Identifier.hpp"
@@ -141,7 +142,7 @@ public:
     return &Parameters_[0];
   }
 
-  std::deque<WrapperParameter> const &getParameters() const
+  llvm::ArrayRef<WrapperParameter> getParameters() const
   { return Parameters_; }
 
   WrapperType getReturnType() const;
@@ -227,7 +228,7 @@ private:
   static WrapperType
   determineReturnType(clang::FunctionDecl const *Decl);
 
-  static std::deque<WrapperParameter>
+  static std::vector<WrapperParameter>
   determineParameters(clang::FunctionDecl const *Decl);
 
   static bool
@@ -245,7 +246,7 @@ private:
 
   Identifier Name_;
   WrapperType ReturnType_;
-  std::deque<WrapperParameter> Parameters_;
+  std::vector<WrapperParameter> Parameters_;
   std::optional<std::string> CustomAction_;
 
   bool IsDefinition_ = false;
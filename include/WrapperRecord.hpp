@@ -10,6 +10,8 @@
 
 #include "clang/AST/DeclCXX.h"
 
+#include "llvm/ADT/ArrayRef.h"
+
 #include "Identifier.hpp"
 #include "IdentifierIndex.hpp"
 #include "LLVMFormat.hpp"
@@ -26,6 +28,7 @@ class WrapperRecord : public WrapperObject<clang::CXXRecordDecl>,
                       public mixin::NotCopyOrMovable
 {
   friend class TypeIndex;
+  friend class Wrapper;
 
 public:
   explicit WrapperRecord(clang::CXXRecordDecl const *Decl,
@@ -48,10 +51,7 @@ public:
 
   std::vector<WrapperRecord const *> getBases(bool Recursive = false) const;
 
-  std::deque<WrapperFunction> const &getFunctions() const
-  { return Functions_; }
-
-  std::deque<WrapperFunction> &getFunctions()
+  llvm::ArrayRef<WrapperFunction> getFunctions() const
   { return Functions_; }
 
   std::deque<WrapperFunction const *> getConstructors() const;
@@ -83,7 +83,7 @@ public:
   { return static_cast<bool>(TemplateArgumentList_); }
 
 private:
-  std::deque<WrapperFunction> determinePublicMemberFunctions(
+  std::vector<WrapperFunction> determinePublicMemberFunctions(
     clang::CXXRecordDecl const *Decl) const;
 
   std::deque<WrapperFunction> determineBaseCasts(
@@ -117,7 +117,7 @@ private:
   Identifier Name_;
   WrapperType Type_;
 
-  std::deque<WrapperFunction> Functions_;
+  std::vector<WrapperFunction> Functions_;
 
   bool IsDefinition_ = false;
   bool IsAbstract_ = false;
@@ -2,6 +2,7 @@
 #define GUARD_WRAPPER_TYPE_H
 
 #include <cassert>
+#include <cstddef>
 #include <deque>
 #include <memory>
 #include <optional>
@@ -103,6 +104,10 @@ public:
   std::optional<WrapperType> proxyFor();
   // Types that this type is publicly derived from (if any).
   std::deque<WrapperType> baseTypes(bool Recursive = false) const;
+  // Offset in bytes of the (possibly indirect) public base 'Base' within
+  // objects of this type, std::nullopt if 'Base' is only reachable via a
+  // virtual base, in which case the offset is only known at runtime.
+  std::optional<std::ptrdiff_t> baseOffset(WrapperType const &Base) const;
 
   WrapperEnum const * asEnum() const;
   WrapperRecord const * asRecord() const;
@@ -149,6 +154,10 @@ private:
   static std::size_t
   determineSize(clang::QualType const &Type);
 
+  static std::optional<std::ptrdiff_t>
+  determineBaseOffset(clang::QualType const &Type,
+                      clang::QualType const &BaseType);
+
   static bool
   _isTemplateInstantiation(clang::QualType const &Type);
 
@@ -1,7 +1,12 @@
+#include <algorithm>
+#include <cstddef>
 #include <filesystem>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "pybind11/embed.h"
@@ -10,11 +15,16 @@
 #include "pybind11/stl.h"
 #include "pybind11/stl_bind.h"
 
+#include "llvm/ADT/ArrayRef.h"
+
 #include "Backend.hpp"
+#include "CommonModule.hpp"
 #include "Env.hpp"
+#include "FrozenBackends.hpp"
 #include "Identifier.hpp"
 #include "Logging.hpp"
 #include "Options.hpp"
+#include "String.hpp"
 #include "Wrapper.hpp"
 #include "WrapperFunction.hpp"
 #include "WrapperInclude.hpp"
@@ -35,12 +45,208 @@ static pybind11::module
 importModule(std::string const &Module)
 { return pybind11::module::import(Module.c_str()); }
 
+// Read-only Python sequence over a range of wrapper objects owned by some other
+// wrapper object. Returning a 'std::vector' instead would make pybind11 build a
+// brand new Python list (and wrapper object for every element) on each call.
+// Here neither the range nor the objects in it are copied and the Python
+// wrapper objects are created lazily and then cached, so repeated lookups
+// always return the same Python objects.
+template<typename T>
+class WrapperObjectView
+{
+public:
+  WrapperObjectView(llvm::ArrayRef<T> Objs, pybind11::object Owner)
+  : Objs_(Objs),
+    Owner_(std::move(Owner)),
+    Items_(Objs.size())
+  {}
+
+  std::size_t size() const
+  { return Objs_.size(); }
+
+  pybind11::object item(std::ptrdiff_t i) const
+  {
+    if (i < 0)
+      i += static_cast<std::ptrdiff_t>(size());
+
+    if (i < 0 || static_cast<std::size_t>(i) >= size())
+      throw pybind11::index_error();
+
+    auto &Item(Items_[i]);
+
+    if (!Item) {
+      Item = pybind11::cast(element(Objs_[i]),
+                            pybind11::return_value_policy::reference_internal,
+                            Owner_);
+    }
+
+    return Item;
+  }
+
+  pybind11::list slice(pybind11::slice const &Slice) const
+  {
+    std::size_t Start, Stop, Step, Length;
+    if (!Slice.compute(size(), &Start, &Stop, &Step, &Length))
+      throw pybind11::error_already_set();
+
+    pybind11::list List;
+    for (std::size_t i = 0; i < Length; ++i, Start += Step)
+      List.append(item(static_cast<std::ptrdiff_t>(Start)));
+
+    return List;
+  }
+
+  pybind11::list list() const
+  {
+    pybind11::list List;
+    for (std::size_t i = 0; i < size(); ++i)
+      List.append(item(static_cast<std::ptrdiff_t>(i)));
+
+    return List;
+  }
+
+  pybind11::iterator iter() const
+  {
+    for (std::size_t i = 0; i < size(); ++i)
+      item(static_cast<std::ptrdiff_t>(i));
+
+    return pybind11::make_iterator(Items_.cbegin(), Items_.cend());
+  }
+
+private:
+  static auto element(T const &Obj)
+  {
+    if constexpr (std::is_pointer_v<T>)
+      return Obj;
+    else
+      return &Obj;
+  }
+
+  llvm::ArrayRef<T> Objs_;
+  pybind11::object Owner_;
+
+  mutable std::vector<pybind11::object> Items_;
+};
+
+template<typename T>
+static void
+bindWrapperObjectView(pybind11::module &m, char const *Name)
+{
+  namespace py = pybind11;
+
+  using View = WrapperObjectView<T>;
+
+  // Views behave like immutable lists, concatenation and slicing yield
+  // ordinary Python lists.
+  py::class_<View>(m, Name)
+    .def("__len__", &View::size)
+    .def("__bool__", [](View const &Self){ return Self.size() > 0; })
+    .def("__getitem__", &View::item)
+    .def("__getitem__", &View::slice)
+    .def("__iter__", &View::iter, py::keep_alive<0, 1>())
+    .def("__add__",
+         [](View const &Self, py::object const &Other)
+         {
+           auto List(Self.list());
+           List.attr("extend")(Other);
+           return List;
+         })
+    .def("__radd__",
+         [](View const &Self, py::object const &Other)
+         {
+           py::list List(Other);
+           List.attr("extend")(Self.list());
+           return List;
+         });
+}
+
+// Return a view of the objects obtained by applying 'Get' to the C++ object
+// wrapped by 'Owner'. The view is created once and then stored in the owner's
+// '__dict__'. Since the wrapper model outlives the Python interpreter, the
+// resulting reference cycle between owner and view is harmless.
+template<typename OWNER, typename GET>
+static pybind11::object
+wrapperObjectView(pybind11::object const &Owner, char const *Key, GET &&Get)
+{
+  namespace py = pybind11;
+
+  py::dict Dict(Owner.attr("__dict__"));
+
+  if (Dict.contains(Key))
+    return Dict[Key];
+
+  auto Objs(Get(Owner.cast<OWNER const &>()));
+
+  using View = WrapperObjectView<typename decltype(Objs)::value_type>;
+
+  auto ObjsView(py::cast(View(Objs, Owner)));
+
+  Dict[Key] = ObjsView;
+
+  return ObjsView;
+}
+
 namespace cppbind
 {
 
 namespace backend
 {
 
+// Make the backend modules frozen into the binary importable by registering a
+// meta path finder for them. Returns false if the frozen modules were compiled
+// by another Python version than the one embedded, in which case the backends
+// have to be imported from the source tree instead.
+static bool
+addFrozenModules()
+{
+  namespace py = pybind11;
+
+  using namespace py::literals;
+
+  auto Magic(frozenModulesMagic());
+
+  py::bytes MagicExpected(importModule("importlib.util").attr("MAGIC_NUMBER"));
+
+  if (std::string(Magic.begin(), Magic.end()) != MagicExpected.cast<std::string>()) {
+    log::warning("frozen backends were compiled by another Python version, "
+                 "importing them from '{0}'", BACKEND_IMPL_DIR);
+    return false;
+  }
+
+  py::dict Modules;
+  for (auto const &Module : frozenModules()) {
+    Modules[Module.Name] =
+      py::bytes(reinterpret_cast<char const *>(Module.Code), Module.Size);
+  }
+
+  py::exec(R"(
+import importlib.abc
+import importlib.util
+import marshal
+import sys
+
+class FrozenBackendFinder(importlib.abc.MetaPathFinder, importlib.abc.Loader):
+    def __init__(self, modules):
+        self._modules = modules
+
+    def find_spec(self, name, path, target=None):
+        if name not in self._modules:
+            return None
+
+        return importlib.util.spec_from_loader(name, self, origin='frozen')
+
+    def create_module(self, spec):
+        return None
+
+    def exec_module(self, module):
+        exec(marshal.loads(self._modules[module.__name__]), module.__dict__)
+
+sys.meta_path.insert(0, FrozenBackendFinder(modules))
+)", py::dict("modules"_a=Modules));
+
+  return true;
+}
+
 void run(std::string const &InputFile, std::shared_ptr<Wrapper> Wrapper)
 {
   // This starts up the Python interpreter and consequently shuts it down when
@@ -48,27 +254,47 @@ void run(std::string const &InputFile, std::shared_ptr<Wrapper> Wrapper)
   pybind11::scoped_interpreter Guard;
 
   try {
+    // Backend modules are imported from those frozen into the binary or,
+    // during development, directly from the source tree.
+    bool Frozen = !OPT(bool, "backend-from-source") && addFrozenModules();
+
     // Backend root directory.
     auto SysMod(importModule("sys"));
 
-    addModuleSearchPath(SysMod, BACKEND_IMPL_COMMON_DIR);
+    if (!Frozen)
+      addModuleSearchPath(SysMod, BACKEND_IMPL_COMMON_DIR);
 
     // List of backends to initialize. Includes both the C backend and the
-    // backend passed by the user via the '--backend' option (if different).
-    // The former is always initialized in order to allow the latter to
-    // generate 'intermediate' C bindings if necessary (as is e.g. the case for
-    // Rust).
+    // backends passed by the user via the '--backend' option (a comma
+    // separated list). The former is always initialized in order to allow the
+    // latter to generate 'intermediate' C bindings if necessary (as is e.g. the
+    // case for Rust). Since all backends operate on the same wrapper and every
+    // backend is run at most once, these are only generated once even if
+    // several backends depend on them.
     std::string CBackend("c");
-    std::string TargetBackend(OPT("backend"));
+
+    std::vector<std::string> TargetBackends;
+
+    for (auto const &TargetBackend : string::split(OPT("backend"), ",")) {
+      auto Backend(string::trim(TargetBackend));
+
+      if (std::find(TargetBackends.begin(), TargetBackends.end(), Backend)
+          == TargetBackends.end()) {
+        TargetBackends.push_back(Backend);
+      }
+    }
 
     std::vector<std::string> Backends { CBackend };
 
-    if (TargetBackend != CBackend)
-      Backends.push_back(TargetBackend);
+    for (auto const &TargetBackend : TargetBackends) {
+      if (TargetBackend != CBackend)
+        Backends.push_back(TargetBackend);
+    }
 
     // Initialize and run backend(s).
     for (auto const &Backend : Backends) {
-      addModuleSearchPath(SysMod, (fs::path(BACKEND_IMPL_DIR) / Backend).string());
+      if (!Frozen)
+        addModuleSearchPath(SysMod, (fs::path(BACKEND_IMPL_DIR) / Backend).string());
 
       importModule(Backend + "_backend");
     }
@@ -78,7 +304,14 @@ void run(std::string const &InputFile, std::shared_ptr<Wrapper> Wrapper)
     for (auto const &Backend : Backends)
       BackendMod.attr("initialize_backend")(Backend, InputFile, Wrapper);
 
-    BackendMod.attr("run_backend")(TargetBackend);
+    auto Outputs(BackendMod.attr("run_backends")(TargetBackends));
+
+    for (auto const &TargetBackend : TargetBackends) {
+      for (auto Output : Outputs[pybind11::str(TargetBackend)]) {
+        log::debug("{0} backend generated '{1}'",
+                   TargetBackend, Output.cast<std::string>());
+      }
+    }
 
   } catch (std::runtime_error const &e) {
     throw log::exception("in backend:\n{0}", e.what());
@@ -161,18 +394,41 @@ PYBIND11_EMBEDDED_MODULE(pycppbind, m)
 
   py::implicitly_convertible<std::string, Identifier>();
 
-  py::class_<Wrapper, std::shared_ptr<Wrapper>>(m, "Wrapper")
-    .def("includes", &Wrapper::getIncludes)
-    .def("macros", &Wrapper::getMacros,
-         py::return_value_policy::reference_internal)
-    .def("enums", &Wrapper::getEnums,
-         py::return_value_policy::reference_internal)
-    .def("variables", &Wrapper::getVariables,
-         py::return_value_policy::reference_internal)
-    .def("functions", &Wrapper::getFunctions,
-         py::return_value_policy::reference_internal)
-    .def("records", &Wrapper::getRecords,
-         py::return_value_policy::reference_internal);
+  bindWrapperObjectView<Include const *>(m, "IncludeView");
+  bindWrapperObjectView<Macro const *>(m, "MacroView");
+  bindWrapperObjectView<Enum const *>(m, "EnumView");
+  bindWrapperObjectView<EnumConstant>(m, "EnumConstantView");
+  bindWrapperObjectView<Variable const *>(m, "VariableView");
+  bindWrapperObjectView<Function const *>(m, "FunctionView");
+  bindWrapperObjectView<Function>(m, "MemberFunctionView");
+  bindWrapperObjectView<Parameter>(m, "ParameterView");
+  bindWrapperObjectView<Record const *>(m, "RecordView");
+
+  py::class_<Wrapper, std::shared_ptr<Wrapper>>(m, "Wrapper", py::dynamic_attr())
+    .def("includes",
+         [](py::object const &Self)
+         { return wrapperObjectView<Wrapper>(Self, "_includes_view",
+                                             std::mem_fn(&Wrapper::getIncludes)); })
+    .def("macros",
+         [](py::object const &Self)
+         { return wrapperObjectView<Wrapper>(Self, "_macros_view",
+                                             std::mem_fn(&Wrapper::getMacros)); })
+    .def("enums",
+         [](py::object const &Self)
+         { return wrapperObjectView<Wrapper>(Self, "_enums_view",
+                                             std::mem_fn(&Wrapper::getEnums)); })
+    .def("variables",
+         [](py::object const &Self)
+         { return wrapperObjectView<Wrapper>(Self, "_variables_view",
+                                             std::mem_fn(&Wrapper::getVariables)); })
+    .def("functions",
+         [](py::object const &Self)
+         { return wrapperObjectView<Wrapper>(Self, "_functions_view",
+                                             std::mem_fn(&Wrapper::getFunctions)); })
+    .def("records",
+         [](py::object const &Self)
+         { return wrapperObjectView<Wrapper>(Self, "_records_view",
+                                             std::mem_fn(&Wrapper::getRecords)); });
 
   py::class_<Type>(m, "Type", py::dynamic_attr())
     .def(py::init<std::string>(),
@@ -222,6 +478,7 @@ PYBIND11_EMBEDDED_MODULE(pycppbind, m)
     .def("proxy_for", &Type::proxyFor)
     .def("base_types", &Type::baseTypes,
          "recursive"_a = false)
+    .def("base_offset", &Type::baseOffset)
     .def("as_enum", &Type::asEnum)
     .def("as_record", &Type::asRecord)
     .def("template_arguments", &Type::templateArguments)
@@ -270,7 +527,10 @@ PYBIND11_EMBEDDED_MODULE(pycppbind, m)
     .def("name", &Enum::getName)
     .def("namespace", &Enum::getNamespace)
     .def("type", &Enum::getType)
-    .def("constants", &Enum::getConstants)
+    .def("constants",
+         [](py::object const &Self)
+         { return wrapperObjectView<Enum>(Self, "_constants_view",
+                                          std::mem_fn(&Enum::getConstants)); })
     .def("is_scoped", &Enum::isScoped)
     .def("is_anonymous", &Enum::isAnonymous)
     .def("is_ambiguous", &Enum::isAmbiguous);
@@ -308,8 +568,9 @@ PYBIND11_EMBEDDED_MODULE(pycppbind, m)
     .def("self", &Function::getSelf,
          py::return_value_policy::reference_internal)
     .def("parameters",
-         py::overload_cast<>(&Function::getParameters, py::const_),
-         py::return_value_policy::reference_internal)
+         [](py::object const &Self)
+         { return wrapperObjectView<Function>(Self, "_parameters_view",
+                                              std::mem_fn(&Function::getParameters)); })
     .def("return_type", &Function::getReturnType)
     .def("custom_action", &Function::getCustomAction)
     .def("overloaded_operator", &Function::getOverloadedOperator)
@@ -339,7 +600,7 @@ PYBIND11_EMBEDDED_MODULE(pycppbind, m)
          "which"_a = nullptr)
     .def("is_template_instantiation", &Function::isTemplateInstantiation);
 
-  py::class_<Parameter>(m, "Parameter")
+  py::class_<Parameter>(m, "Parameter", py::dynamic_attr())
     .def("name", &Parameter::getName)
     .def("namespace", &Parameter::getNamespace)
     .def("type", &Parameter::getType)
@@ -356,8 +617,9 @@ PYBIND11_EMBEDDED_MODULE(pycppbind, m)
     .def("bases", &Record::getBases,
          "recursive"_a = false)
     .def("functions",
-         py::overload_cast<>(&Record::getFunctions, py::const_),
-         py::return_value_policy::reference_internal)
+         [](py::object const &Self)
+         { return wrapperObjectView<Record>(Self, "_functions_view",
+                                            std::mem_fn(&Record::getFunctions)); })
     .def("constructors", &Record::getConstructors,
          py::return_value_policy::reference_internal)
     .def("default_constructor", &Record::getDefaultConstructor,
@@ -396,7 +658,14 @@ PYBIND11_EMBEDDED_MODULE(pycppbind, m)
     RO_PROP("output_c_source_extension", OPT("output-c-source-extension"))
     RO_PROP("output_cpp_header_extension", OPT("output-cpp-header-extension"))
     RO_PROP("output_cpp_source_extension", OPT("output-cpp-source-extension"))
+    RO_PROP("backend_parallel", OPT(bool, "backend-parallel"))
+    RO_PROP("output_common_module", OPT("output-common-module"))
     RO_PROP("output_relative_includes", OPT(bool, "output-relative-includes"))
+    RO_PROP("wrap_call_thunks", OPT(bool, "wrap-call-thunks"))
+    RO_PROP("output_pch", OPT(bool, "output-pch"))
+    RO_PROP("output_incremental", OPT(bool, "output-incremental"))
+    RO_PROP("output_content_hash", OPT(bool, "output-content-hash"))
+    RO_PROP("output_shards", OPT(int, "output-shards"))
     RO_PROP("rust_no_enums", OPT(bool, "rust-no-enums"))
     RO_PROP("lua_include_dir", OPT("lua-include-dir"))
     RO_PROP("lua_include_cpp", OPT(bool, "lua-include-cpp"));
@@ -406,4 +675,16 @@ PYBIND11_EMBEDDED_MODULE(pycppbind, m)
   py::class_<Env_>(m, "Env")
     .def_static("get", [](std::string const &Key){ return Env().get(Key); })
     .def_static("set", [](std::string const &Key, std::string const &Val){ Env().set(Key, Val); });
+
+  struct CommonModule_ {};
+
+  py::class_<CommonModule_>(m, "CommonModule")
+    .def_static("add",
+                [](std::string const &File,
+                   std::string const &Key,
+                   std::string const &Section)
+                { return CommonModule().add(File, Key, Section); })
+    .def_static("sections",
+                [](std::string const &File)
+                { return CommonModule().sections(File); });
 }
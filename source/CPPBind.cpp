@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstdlib>
 #include <exception>
 #include <regex>
@@ -16,10 +17,22 @@ clang::tooling::CommonOptionsParser
 static OptionsParser(int argc, char const **argv)
 {
   Options().add<std::string>("backend")
-    .setDescription("Language for which to create bindings")
+    .setDescription("Language(s) for which to create bindings, "
+                    "use a comma separated list to specify several")
     .setOptional(false)
     .done();
 
+  Options().add<bool>("backend-from-source")
+    .setDescription("Import backends from the source tree instead of using "
+                    "the ones frozen into the binary")
+    .setDefault(false)
+    .done();
+
+  Options().add<bool>("backend-parallel")
+    .setDescription("Run several backends in parallel worker processes")
+    .setDefault(false)
+    .done();
+
   Options().add<std::vector<std::string>>("template-instantiations")
     .setDescription("File containing extra template instantiations", "path")
     .done();
@@ -28,6 +41,11 @@ static OptionsParser(int argc, char const **argv)
     .setDescription("Matcher rule for declarations to be wrapped")
     .done();
 
+  Options().add<std::vector<std::string>>("wrap-prune-roots")
+    .setDescription("Only wrap enums, functions and records reachable from "
+                    "those whose qualified names match this regex", "regex")
+    .done();
+
   Options().add<bool>("wrap-macro-constants")
     .setDescription("Create constants from simple macros")
     .setDefault(false)
@@ -52,6 +70,12 @@ static OptionsParser(int argc, char const **argv)
     .setDefault(false)
     .done();
 
+  Options().add<bool>("wrap-call-thunks")
+    .setDescription("Forward simple wrapper functions to generic call thunks "
+                    "instead of generating their bodies in full")
+    .setDefault(false)
+    .done();
+
   Options().add<std::string>("wrap-func-overload-postfix")
     .setDescription("Wrapper function overload postfix, "
                     "use %o to denote #overload", "postfix")
@@ -98,11 +122,57 @@ static OptionsParser(int argc, char const **argv)
     .setDefault(".cc")
     .done();
 
+  Options().add<std::string>("output-common-module")
+    .setDescription("Emit types shared between input files into a common "
+                    "module with this name instead of once per input file", "name")
+    .setDefault("")
+    .done();
+
   Options().add<bool>("output-relative-includes")
     .setDescription("Use relative include paths in generated files")
     .setDefault(false)
     .done();
 
+  Options().add<bool>("output-pch")
+    .setDescription("Move common includes of generated sources into a "
+                    "prefix header suitable for precompilation")
+    .setDefault(false)
+    .done();
+
+  Options().add<bool>("output-incremental")
+    .setDescription("Assign entities to output shards stably and don't "
+                    "rewrite output files whose content is unchanged, changed "
+                    "declarations still affect all shards")
+    .setDefault(false)
+    .done();
+
+  Options().add<std::vector<std::string>>("output-path-prefix-map")
+    .setDescription("Replace the prefix OLD of absolute paths in generated "
+                    "files with NEW", "OLD=NEW")
+    .addAssertion([](std::vector<std::string> const &Maps){
+                    return std::all_of(Maps.begin(), Maps.end(),
+                                       [](std::string const &Map){
+                                         return Map.find('=') != std::string::npos;
+                                       });
+                  },
+                  "Path prefix maps must have the form OLD=NEW")
+    .done();
+
+  Options().add<bool>("output-content-hash")
+    .setDescription("Start generated source and CMake files with a comment "
+                    "containing a hash of their content, usable as a build "
+                    "cache key")
+    .setDefault(false)
+    .done();
+
+  Options().add<int>("output-shards")
+    .setDescription("Number of source files between which generated "
+                    "function definitions are distributed")
+    .setDefault(1)
+    .addAssertion([](int Shards){ return Shards >= 1; },
+                  "Number of output shards must be positive")
+    .done();
+
   // XXX backend options should not be implemented in C++
   Options().add<bool>("rust-no-enums")
     .setDescription("Always transform C++ enums into Rust constants")
@@ -275,6 +275,12 @@ CreateWrapperFrontendAction::afterProcessing()
 
   Wrapper_->addOverloads();
 
+  // Pruning only after overloads have been numbered keeps the names of
+  // wrapper functions independent of the set of prune roots.
+  auto PruneRoots(OPT(std::vector<std::string>, "wrap-prune-roots"));
+  if (!PruneRoots.empty())
+    Wrapper_->pruneUnreachable(PruneRoots);
+
   backend::run(InputFile_, Wrapper_);
 }
 
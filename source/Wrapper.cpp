@@ -1,9 +1,15 @@
+#include <algorithm>
 #include <cassert>
-#include <deque>
+#include <cstddef>
+#include <regex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include "llvm/ADT/ArrayRef.h"
+
 #include "CompilerState.hpp"
 #include "Identifier.hpp"
 #include "IdentifierIndex.hpp"
@@ -11,67 +17,199 @@
 #include "TypeIndex.hpp"
 #include "Wrapper.hpp"
 
-namespace
+namespace cppbind
 {
-  template<typename T>
-  static std::vector<T const *> dequeToVector(std::deque<T> const &D) {
-    std::vector<T const *> V;
-    V.reserve(D.size());
 
-    for (auto const &Obj : D)
-      V.push_back(&Obj);
+void
+Wrapper::addOverloads()
+{
+  for (auto *Wr : Records_.objects())
+    Wr->addOverloads(CompilerState().identifiers());
 
-    return V;
-  }
+  for (auto *Wf : Functions_.objects())
+    Wf->addOverload(CompilerState().identifiers());
 }
 
-namespace cppbind
-{
-
 void
-Wrapper::addOverloads()
+Wrapper::pruneUnreachable(std::vector<std::string> const &Roots)
 {
-  for (auto &Wr : Records_)
-    Wr.addOverloads(CompilerState().identifiers());
+  std::vector<std::regex> RootRegexes;
+
+  for (auto const &Root : Roots) {
+    try {
+      RootRegexes.emplace_back(Root);
+    } catch (std::regex_error const &e) {
+      throw log::exception("invalid prune root '{0}': {1}", Root, e.what());
+    }
+  }
+
+  auto isRoot = [&](Identifier const &Name)
+  {
+    auto NameStr(Name.str());
+
+    for (auto const &RootRegex : RootRegexes) {
+      if (std::regex_match(NameStr, RootRegex))
+        return true;
+    }
+
+    return false;
+  };
+
+  std::unordered_set<WrapperEnum const *> Enums;
+  std::unordered_set<WrapperFunction const *> Functions;
+  std::unordered_set<WrapperRecord const *> Records;
+
+  std::vector<WrapperRecord const *> RecordsTodo;
+
+  auto reachRecord = [&](WrapperRecord const *Record)
+  {
+    if (Records.insert(Record).second)
+      RecordsTodo.push_back(Record);
+  };
+
+  auto reachType = [&](WrapperType Type)
+  {
+    Type = Type.canonical();
+
+    while (Type.isIndirection())
+      Type = Type.pointee();
+
+    if (Type.isRecord()) {
+      if (auto const *Record = Type.asRecord())
+        reachRecord(Record);
+    } else if (Type.isEnum()) {
+      if (auto const *Enum = Type.asEnum())
+        Enums.insert(Enum);
+    }
+  };
+
+  auto reachFunction = [&](WrapperFunction const *Function)
+  {
+    reachType(Function->getReturnType());
+
+    for (auto const &Param : Function->getParameters())
+      reachType(Param.getType());
+  };
+
+  for (auto const *Enum : getEnums()) {
+    if (isRoot(Enum->getName()))
+      Enums.insert(Enum);
+  }
+
+  for (auto const *Variable : Variables_.objects())
+    reachType(Variable->getType());
 
-  for (auto &Wf : Functions_)
-    Wf.addOverload(CompilerState().identifiers());
+  for (auto const *Function : getFunctions()) {
+    if (isRoot(Function->getName())) {
+      Functions.insert(Function);
+      reachFunction(Function);
+    }
+  }
+
+  for (auto const *Record : getRecords()) {
+    if (isRoot(Record->getName()))
+      reachRecord(Record);
+  }
+
+  while (!RecordsTodo.empty()) {
+    auto const *Record = RecordsTodo.back();
+    RecordsTodo.pop_back();
+
+    for (auto const *Base : Record->getBases(true))
+      reachRecord(Base);
+
+    for (auto const &Function : Record->getFunctions())
+      reachFunction(&Function);
+  }
+
+  // Report and drop everything that was not reached.
+  auto prune = [&](auto Objs, auto const &Reachable)
+  {
+    std::vector<typename decltype(Objs)::value_type> Kept;
+
+    for (auto const *Obj : Objs) {
+      if (Reachable.find(Obj) != Reachable.end())
+        Kept.push_back(Obj);
+      else
+        log::debug("pruning unreachable {0}", *Obj);
+    }
+
+    return Kept;
+  };
+
+  auto NumEnums(getEnums().size());
+  auto NumFunctions(getFunctions().size());
+  auto NumRecords(getRecords().size());
+
+  EnumsReachable_ = prune(getEnums(), Enums);
+  FunctionsReachable_ = prune(getFunctions(), Functions);
+
+  auto RecordsKept(prune(getRecords(), Records));
+
+  RecordsReachable_.emplace(RecordsKept.begin(), RecordsKept.end());
+  RecordsOrdered_.reset();
+
+  auto report = [](char const *What, std::size_t Kept, std::size_t Total)
+  {
+    if (Kept < Total)
+      log::debug("pruned {0} of {1} {2}", Total - Kept, Total, What);
+  };
+
+  report("enums", EnumsReachable_->size(), NumEnums);
+  report("functions", FunctionsReachable_->size(), NumFunctions);
+  report("records", RecordsKept.size(), NumRecords);
 }
 
-std::vector<WrapperInclude const *>
+llvm::ArrayRef<WrapperInclude const *>
 Wrapper::getIncludes() const
-{ return dequeToVector(Includes_); }
+{ return Includes_.objects(); }
 
-std::vector<WrapperMacro const *>
+llvm::ArrayRef<WrapperMacro const *>
 Wrapper::getMacros() const
-{ return dequeToVector(Macros_); }
+{ return Macros_.objects(); }
 
-std::vector<WrapperEnum const *>
+llvm::ArrayRef<WrapperEnum const *>
 Wrapper::getEnums() const
-{ return dequeToVector(Enums_); }
+{
+  if (EnumsReachable_)
+    return *EnumsReachable_;
+
+  return Enums_.objects();
+}
 
-std::vector<WrapperVariable const *>
+llvm::ArrayRef<WrapperVariable const *>
 Wrapper::getVariables() const
-{ return dequeToVector(Variables_); }
+{ return Variables_.objects(); }
 
-std::vector<WrapperFunction const *>
+llvm::ArrayRef<WrapperFunction const *>
 Wrapper::getFunctions() const
 {
-  std::vector<WrapperFunction const *> Funcs;
-  Funcs.reserve(Functions_.size());
+  if (FunctionsReachable_)
+    return *FunctionsReachable_;
 
-  for (auto const &Func : Functions_)
-    Funcs.push_back(&Func);
-
-  return Funcs;
+  return Functions_.objects();
 }
 
-std::vector<WrapperRecord const *>
+llvm::ArrayRef<WrapperRecord const *>
 Wrapper::getRecords() const
 {
-  std::vector<WrapperRecord const *> Records;
+  // The bases first ordering requires a topological sort of the record graph
+  // so we only compute it once after the last record has been added.
+  if (!RecordsOrdered_) {
+    RecordsOrdered_ = CompilerState().types()->getRecordBasesFirstOrdering();
+
+    if (RecordsReachable_) {
+      auto &Records(*RecordsOrdered_);
+
+      Records.erase(std::remove_if(Records.begin(),
+                                   Records.end(),
+                                   [this](WrapperRecord const *Record)
+                                   { return RecordsReachable_->count(Record) == 0; }),
+                    Records.end());
+    }
+  }
 
-  return CompilerState().types()->getRecordBasesFirstOrdering();
+  return *RecordsOrdered_;
 }
 
 bool
@@ -173,18 +311,25 @@ Wrapper::_addWrapperRecord(WrapperRecord *Record)
 
     CompilerState().types()->addRecordDefinition(Record);
 
-    auto &Functions(Record->getFunctions());
+    // Filter member functions in a single compaction pass. Every candidate is
+    // moved into its final position *before* it is registered so that the
+    // pointers stored in 'FunctionNames_' remain valid.
+    auto &Functions(Record->Functions_);
 
-    auto It(Functions.begin());
-    while (It != Functions.end()) {
-      log::debug("considering member {0}", *It);
+    std::size_t Kept = 0;
 
-      if (!_addWrapperFunction(&(*It)))
-        It = Functions.erase(It);
-      else
-        ++It;
+    for (std::size_t i = 0; i < Functions.size(); ++i) {
+      if (Kept != i)
+        Functions[Kept] = std::move(Functions[i]);
+
+      log::debug("considering member {0}", Functions[Kept]);
+
+      if (_addWrapperFunction(&Functions[Kept]))
+        ++Kept;
     }
 
+    Functions.erase(Functions.begin() + Kept, Functions.end());
+
   } else {
     log::debug("not a definition");
 
@@ -280,7 +280,7 @@ postfixParameterName(std::string &ParamName, unsigned p)
   ParamName += Postfix;
 }
 
-std::deque<WrapperParameter>
+std::vector<WrapperParameter>
 WrapperFunction::determineParameters(clang::FunctionDecl const *Decl)
 {
   auto Params(Decl->parameters());
@@ -318,7 +318,8 @@ WrapperFunction::determineParameters(clang::FunctionDecl const *Decl)
   }
 
   // construct parameter list
-  std::deque<WrapperParameter> ParamList;
+  std::vector<WrapperParameter> ParamList;
+  ParamList.reserve(Params.size());
 
   for (unsigned i = 0u; i < Params.size(); ++i) {
     ParamList.emplace_back(Identifier(ParamNames[i]),
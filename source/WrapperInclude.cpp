@@ -1,7 +1,9 @@
 #include <filesystem>
 #include <sstream>
 #include <string>
+#include <vector>
 
+#include "Options.hpp"
 #include "WrapperInclude.hpp"
 
 namespace fs = std::filesystem;
@@ -9,6 +11,28 @@ namespace fs = std::filesystem;
 namespace cppbind
 {
 
+namespace
+{
+
+// Apply '--output-path-prefix-map' to an absolute path, if several prefixes
+// match, the one specified last wins.
+std::string remapPath(std::string const &Path)
+{
+  auto Maps(OPT(std::vector<std::string>, "output-path-prefix-map"));
+
+  for (auto It = Maps.rbegin(); It != Maps.rend(); ++It) {
+    auto Sep(It->find('='));
+    auto Old(It->substr(0, Sep));
+
+    if (Path.compare(0, Old.size(), Old) == 0)
+      return It->substr(Sep + 1) + Path.substr(Old.size());
+  }
+
+  return Path;
+}
+
+} // namespace
+
 WrapperInclude::WrapperInclude(std::string const &Path, bool IsSystem)
 : IsSystem_(IsSystem)
 {
@@ -24,9 +48,12 @@ WrapperInclude::WrapperInclude(std::string const &Path, bool IsSystem)
 std::string
 WrapperInclude::path(bool Relative) const
 {
-  if (!IsAbsolute_ || !Relative)
+  if (!IsAbsolute_)
     return Path_;
 
+  if (!Relative)
+    return remapPath(Path_);
+
   return fs::path(Path_).filename().string();
 }
 
@@ -168,14 +168,14 @@ WrapperRecord::isPolymorphic() const
   return false;
 }
 
-std::deque<WrapperFunction>
+std::vector<WrapperFunction>
 WrapperRecord::determinePublicMemberFunctions(
   clang::CXXRecordDecl const *Decl) const
 {
   if (!Decl->isThisDeclarationADefinition())
     return {};
 
-  std::deque<WrapperFunction> PublicMemberFunctions;
+  std::vector<WrapperFunction> PublicMemberFunctions;
 
   // member functions
   auto PublicMemberFunctionsDecls(determinePublicMemberFunctionDecls(Decl, true));
@@ -272,7 +272,7 @@ WrapperType::proxyFor()
       if (Constructor->isCopyConstructor() || Constructor->isMoveConstructor())
         continue;
 
-      auto const &Params(Constructor->getParameters());
+      auto Params(Constructor->getParameters());
 
       if (Params.size() == 0)
         continue;
@@ -345,6 +345,10 @@ WrapperType::baseTypes(bool Recursive) const
   return BaseWrapperTypes;
 }
 
+std::optional<std::ptrdiff_t>
+WrapperType::baseOffset(WrapperType const &Base) const
+{ return determineBaseOffset(type(), Base.type()); }
+
 WrapperType
 WrapperType::lvalueReferenceTo() const
 { return WrapperType(ASTContext().getLValueReferenceType(type())); }
@@ -548,6 +552,48 @@ WrapperType::determineSize(clang::QualType const &Type)
   return ASTContext().getTypeInfo(Type).Width;
 }
 
+std::optional<std::ptrdiff_t>
+WrapperType::determineBaseOffset(clang::QualType const &Type,
+                                 clang::QualType const &BaseType)
+{
+  auto CXXRecordDecl = Type->getAsCXXRecordDecl();
+  auto BaseCXXRecordDecl = BaseType->getAsCXXRecordDecl();
+
+  if (!CXXRecordDecl || !BaseCXXRecordDecl)
+    return std::nullopt;
+
+  CXXRecordDecl = CXXRecordDecl->getDefinition();
+  if (!CXXRecordDecl)
+    return std::nullopt;
+
+  auto const &Layout = ASTContext().getASTRecordLayout(CXXRecordDecl);
+
+  // Only follow the same public bases as 'baseTypes', the offsets of
+  // non-virtual bases are summed up along the way.
+  for (auto const &Base : CXXRecordDecl->bases()) {
+    if (Base.getAccessSpecifier() != clang::AS_public || Base.isVirtual())
+      continue;
+
+    auto DirectBaseCXXRecordDecl = Base.getType()->getAsCXXRecordDecl();
+    if (!DirectBaseCXXRecordDecl)
+      continue;
+
+    auto Offset(static_cast<std::ptrdiff_t>(
+      Layout.getBaseClassOffset(DirectBaseCXXRecordDecl).getQuantity()));
+
+    if (DirectBaseCXXRecordDecl->getCanonicalDecl() ==
+        BaseCXXRecordDecl->getCanonicalDecl()) {
+      return Offset;
+    }
+
+    auto BaseOffset(determineBaseOffset(Base.getType(), BaseType));
+    if (BaseOffset)
+      return Offset + *BaseOffset;
+  }
+
+  return std::nullopt;
+}
+
 bool
 WrapperType::_isTemplateInstantiation(clang::QualType const &Type)
 {